@@ -0,0 +1,133 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <itkImage.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+
+#include "itkConnectivity.h"
+#include "itkLineTerminalityImageFunction.h"
+#include "itkSimplicityByTopologicalNumbersImageFunction.h"
+#include "itkSurfaceTerminalityImageFunction.h"
+#include "itkTopologicalNumberImageFunction.h"
+
+typedef itk::Image<unsigned char, 3> ImageType;
+typedef itk::Connectivity<3, 0> ConnectivityType;
+
+/**
+ * True if the batch evaluations at offsets and at indices agree with the
+ * evaluation at index on count points that are not on the border of the
+ * image, taken out of the raster order.
+ */
+template<typename TFunction>
+bool sameEvaluations(ImageType const * image, unsigned long count)
+  {
+  typedef typename TFunction::OutputType OutputType;
+
+  typename TFunction::Pointer function = TFunction::New();
+  function->SetInputImage(image);
+  function->SetForegroundValue(255);
+
+  ImageType::RegionType const region = image->GetBufferedRegion();
+  std::vector<ImageType::IndexType> inside;
+  for(itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, region);
+      !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType const index = it.GetIndex();
+    bool border = false;
+    for(unsigned int j = 0; j < 3; ++j)
+      {
+      border = border || index[j] == 0 ||
+        index[j] == static_cast<long>(region.GetSize()[j])-1;
+      }
+    if(!border)
+      {
+      inside.push_back(index);
+      }
+    }
+
+  std::vector<ImageType::IndexType> indices;
+  std::vector<ImageType::OffsetValueType> offsets;
+  for(unsigned long i = 0; i < count; ++i)
+    {
+    indices.push_back(inside[(37*i) % inside.size()]);
+    offsets.push_back(image->ComputeOffset(indices.back()));
+    }
+
+  OutputType * atOffsets = new OutputType[count];
+  OutputType * atIndices = new OutputType[count];
+  function->EvaluateAtOffsets(&offsets[0], count, atOffsets);
+  function->EvaluateAtIndices(&indices[0], count, atIndices);
+  bool same = true;
+  for(unsigned long i = 0; i < count; ++i)
+    {
+    OutputType const atIndex = function->EvaluateAtIndex(indices[i]);
+    same = same && atOffsets[i] == atIndex && atIndices[i] == atIndex;
+    }
+  delete[] atOffsets;
+  delete[] atIndices;
+  return same;
+  }
+
+
+int main(int, char**)
+{
+  // Noise, so that the configurations vary from a point to the next
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill(12);
+  image->SetRegions(size);
+  image->Allocate();
+  unsigned long seed = 1;
+  for(itk::ImageRegionIterator<ImageType> it(
+        image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    seed = (1103515245*seed + 12345) % 2147483648UL;
+    it.Set(((seed >> 16) & 1) ? 255 : 0);
+    }
+
+  // The counts are not multiples of the batch size, so that the last batch
+  // is partial.
+  unsigned long const counts[] = { 1, 63, 65, 130, 201 };
+  unsigned int errors = 0;
+  for(unsigned int i = 0; i < sizeof(counts)/sizeof(counts[0]); ++i)
+    {
+    if(!sameEvaluations<itk::SimplicityByTopologicalNumbersImageFunction<
+         ImageType, ConnectivityType> >(image, counts[i]))
+      {
+      std::cerr << "different simplicity on " << counts[i] << " points"
+                << std::endl;
+      ++errors;
+      }
+    if(!sameEvaluations<itk::LineTerminalityImageFunction<
+         ImageType, ConnectivityType> >(image, counts[i]))
+      {
+      std::cerr << "different line terminality on " << counts[i]
+                << " points" << std::endl;
+      ++errors;
+      }
+    if(!sameEvaluations<itk::SurfaceTerminalityImageFunction<
+         ImageType, ConnectivityType> >(image, counts[i]))
+      {
+      std::cerr << "different surface terminality on " << counts[i]
+                << " points" << std::endl;
+      ++errors;
+      }
+    if(!sameEvaluations<itk::TopologicalNumberImageFunction<
+         ImageType, ConnectivityType> >(image, counts[i]))
+      {
+      std::cerr << "different topological numbers on " << counts[i]
+                << " points" << std::endl;
+      ++errors;
+      }
+    }
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include "itkChamferDistanceTransformImageFilter.h"
+
+typedef itk::Image<unsigned char, 3> ImageType;
+typedef itk::Image<unsigned int, 3> DistanceImageType;
+typedef itk::ChamferDistanceTransformImageFilter<ImageType, DistanceImageType>
+  DistanceFilterType;
+
+/** Point of a chamfer mask, and its weight. */
+struct MaskPoint
+  {
+  ImageType::OffsetType Offset;
+  unsigned int Weight;
+  };
+
+typedef std::vector<MaskPoint> MaskType;
+
+
+/**
+ * Mask of the points of the unit cube weighted by (5, 7, 9) and, if
+ * largeMask is set, of the points at a distance 2 weighted by 11 for the
+ * knight moves (2, 1, 0), 12 for (2, 1, 1) and 15 for (2, 2, 1).
+ */
+MaskType buildMask(bool largeMask)
+  {
+  MaskType mask;
+  MaskPoint point;
+  for(point.Offset[2] = -2; point.Offset[2] <= 2; ++point.Offset[2])
+    {
+    for(point.Offset[1] = -2; point.Offset[1] <= 2; ++point.Offset[1])
+      {
+      for(point.Offset[0] = -2; point.Offset[0] <= 2; ++point.Offset[0])
+        {
+        unsigned int ones = 0;
+        unsigned int twos = 0;
+        for(unsigned int j = 0; j < 3; ++j)
+          {
+          ones += (std::abs(point.Offset[j]) == 1);
+          twos += (std::abs(point.Offset[j]) == 2);
+          }
+        point.Weight = 0;
+        if(twos == 0 && ones != 0)
+          {
+          point.Weight = 3+2*ones;
+          }
+        else if(largeMask && twos == 1 && ones != 0)
+          {
+          point.Weight = 10+ones;
+          }
+        else if(largeMask && twos == 2 && ones == 1)
+          {
+          point.Weight = 15;
+          }
+        if(point.Weight != 0)
+          {
+          mask.push_back(point);
+          }
+        }
+      }
+    }
+  return mask;
+  }
+
+
+/** True if offset is before the center in the raster order. */
+bool isBefore(ImageType::OffsetType const & offset)
+  {
+  for(int j = 2; j >= 0; --j)
+    {
+    if(offset[j] != 0)
+      {
+      return offset[j] < 0;
+      }
+    }
+  return false;
+  }
+
+
+/**
+ * Chamfer distance computed by the two raster scans on the whole image, in
+ * a single thread and point by point. The points outside of the image are
+ * in the background.
+ */
+std::vector<unsigned int> naiveDistance(ImageType const * image,
+                                        MaskType const & mask,
+                                        bool distanceFromObject)
+  {
+  ImageType::RegionType const region = image->GetBufferedRegion();
+  ImageType::SizeType const size = region.GetSize();
+  unsigned int const infinity = itk::NumericTraits<unsigned int>::max();
+  unsigned int const objectValue = distanceFromObject ? 0 : infinity;
+  unsigned int const backgroundValue = infinity - objectValue;
+
+  std::vector<unsigned int> distance;
+  for(itk::ImageRegionConstIterator<ImageType> it(image, region);
+      !it.IsAtEnd(); ++it)
+    {
+    distance.push_back((it.Get() == 255) ? objectValue : backgroundValue);
+    }
+
+  for(unsigned int pass = 0; pass < 2; ++pass)
+    {
+    for(unsigned long i = 0; i < distance.size(); ++i)
+      {
+      unsigned long const point = (pass == 0) ? i : distance.size()-1-i;
+      ImageType::IndexType index;
+      index[0] = point % size[0];
+      index[1] = (point / size[0]) % size[1];
+      index[2] = point / (size[0]*size[1]);
+      for(MaskType::const_iterator it = mask.begin(); it != mask.end(); ++it)
+        {
+        if(isBefore(it->Offset) != (pass == 0))
+          {
+          continue;
+          }
+        ImageType::IndexType const neighbor = index + it->Offset;
+        unsigned int value = backgroundValue;
+        if(region.IsInside(neighbor))
+          {
+          value = distance[neighbor[0] + size[0]*(neighbor[1] +
+                                                  size[1]*neighbor[2])];
+          }
+        if(value < infinity - it->Weight &&
+           value + it->Weight < distance[point])
+          {
+          distance[point] = value + it->Weight;
+          }
+        }
+      }
+    }
+
+  return distance;
+  }
+
+
+DistanceFilterType::Pointer newDistanceFilter(MaskType const & mask,
+                                              bool distanceFromObject)
+  {
+  DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
+  unsigned int weights[] = { 5, 7, 9 };
+  distanceFilter->SetWeights(weights, weights+3);
+  for(MaskType::const_iterator it = mask.begin(); it != mask.end(); ++it)
+    {
+    if(it->Weight > 9)
+      {
+      distanceFilter->SetOffsetWeight(it->Offset, it->Weight);
+      }
+    }
+  distanceFilter->SetDistanceFromObject(distanceFromObject);
+  distanceFilter->SetForegroundValue(255);
+  return distanceFilter;
+  }
+
+
+/**
+ * Image of a ball cut by the image, and of scattered points, with the given
+ * number of planes.
+ */
+ImageType::Pointer newImage(unsigned long planes)
+  {
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 29;
+  size[1] = 23;
+  size[2] = planes;
+  image->SetRegions(size);
+  image->Allocate();
+
+  for(itk::ImageRegionIteratorWithIndex<ImageType> it(
+        image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType const index = it.GetIndex();
+    long const x = index[0]-12;
+    long const y = index[1]-10;
+    long const z = index[2]-4;
+    bool const inBall = (x*x + y*y + 4*z*z <= 64);
+    bool const scattered =
+      ((7*index[0] + 13*index[1] + 31*index[2]) % 53 == 0);
+    it.Set((inBall || scattered) ? 255 : 0);
+    }
+  return image;
+  }
+
+
+int main(int, char**)
+{
+  // A few planes only, so that some runs have more threads than planes
+  ImageType::Pointer image = newImage(7);
+
+  unsigned int errors = 0;
+  unsigned int const threads[] = { 1, 2, 3, 16 };
+  for(unsigned int largeMask = 0; largeMask < 2; ++largeMask)
+    {
+    MaskType const mask = buildMask(largeMask != 0);
+    for(unsigned int fromObject = 0; fromObject < 2; ++fromObject)
+      {
+      std::vector<unsigned int> const expected =
+        naiveDistance(image, mask, fromObject != 0);
+      for(unsigned int i = 0; i < sizeof(threads)/sizeof(threads[0]); ++i)
+        {
+        DistanceFilterType::Pointer distanceFilter =
+          newDistanceFilter(mask, fromObject != 0);
+        distanceFilter->SetNumberOfThreads(threads[i]);
+        distanceFilter->SetInput(image);
+        distanceFilter->Update();
+
+        DistanceImageType::Pointer const distance =
+          distanceFilter->GetOutput();
+        std::vector<unsigned int> const computed(
+          distance->GetBufferPointer(),
+          distance->GetBufferPointer() + expected.size());
+        if(computed != expected)
+          {
+          std::cerr << "wrong distance with " << threads[i] << " threads, "
+                    << (largeMask ? "5x5x5" : "3x3x3") << " mask, "
+                    << (fromObject ? "from" : "in") << " the object"
+                    << std::endl;
+          ++errors;
+          }
+        }
+
+      // Edits adding and removing boxes of the object, brought up to date
+      // by UpdateDistances
+      ImageType::Pointer edited = ImageType::New();
+      edited->SetRegions(image->GetBufferedRegion());
+      edited->Allocate();
+      std::copy(image->GetBufferPointer(),
+                image->GetBufferPointer() +
+                  image->GetBufferedRegion().GetNumberOfPixels(),
+                edited->GetBufferPointer());
+      DistanceFilterType::Pointer distanceFilter =
+        newDistanceFilter(mask, fromObject != 0);
+      distanceFilter->SetInput(edited);
+      distanceFilter->Update();
+      DistanceImageType::Pointer const distance = distanceFilter->GetOutput();
+
+      long const edits[][7] = { { 9, 14, 8, 12, 2, 5, 0 },
+                                { 20, 24, 3, 6, 0, 2, 255 },
+                                { 0, 3, 18, 22, 3, 6, 255 },
+                                { 11, 13, 9, 11, 0, 6, 0 } };
+      for(unsigned int e = 0; e < sizeof(edits)/sizeof(edits[0]); ++e)
+        {
+        ImageType::IndexType index;
+        ImageType::SizeType editSize;
+        for(unsigned int j = 0; j < 3; ++j)
+          {
+          index[j] = edits[e][2*j];
+          editSize[j] = edits[e][2*j+1] - edits[e][2*j] + 1;
+          }
+        ImageType::RegionType const dirty(index, editSize);
+        for(itk::ImageRegionIteratorWithIndex<ImageType> it(edited, dirty);
+            !it.IsAtEnd(); ++it)
+          {
+          it.Set(static_cast<unsigned char>(edits[e][6]));
+          }
+        distanceFilter->UpdateDistances(edited, distance, dirty);
+
+        std::vector<unsigned int> const updated(
+          distance->GetBufferPointer(),
+          distance->GetBufferPointer() + expected.size());
+        if(updated != naiveDistance(edited, mask, fromObject != 0))
+          {
+          std::cerr << "wrong update after edit " << e << ", "
+                    << (largeMask ? "5x5x5" : "3x3x3") << " mask, "
+                    << (fromObject ? "from" : "in") << " the object"
+                    << std::endl;
+          ++errors;
+          }
+        }
+      }
+    }
+
+  // More threads than processors, each of them having planes to scan : the
+  // threads waiting for the previous planes must let the others run.
+  ImageType::Pointer const tall = newImage(60);
+  MaskType const mask = buildMask(false);
+  unsigned int const oversubscribed = std::min(
+    4*itk::MultiThreader::GetGlobalDefaultNumberOfThreads(), 60);
+  DistanceFilterType::Pointer distanceFilter = newDistanceFilter(mask, false);
+  distanceFilter->SetNumberOfThreads(oversubscribed);
+  distanceFilter->SetInput(tall);
+  distanceFilter->Update();
+  std::vector<unsigned int> const expected = naiveDistance(tall, mask, false);
+  if(std::vector<unsigned int>(
+       distanceFilter->GetOutput()->GetBufferPointer(),
+       distanceFilter->GetOutput()->GetBufferPointer() + expected.size()) !=
+     expected)
+    {
+    std::cerr << "wrong distance with " << oversubscribed << " threads"
+              << std::endl;
+    ++errors;
+    }
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
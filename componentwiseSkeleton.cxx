@@ -0,0 +1,88 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <itkImage.h>
+
+#include "itkConnectivity.h"
+#include "itkSkeletonizeImageFilter.h"
+#include "skeletonTestHelpers.h"
+
+typedef itk::SkeletonizeImageFilter<ImageType, itk::Connectivity<3, 0> >
+  SkeletonizerType;
+
+/**
+ * Skeleton of the object, the components being thinned one by one when
+ * numberOfThreads is not 0, and in a single pass otherwise.
+ */
+ImageType::Pointer skeletonize(ImageType * object,
+                               unsigned int numberOfThreads)
+  {
+  DistanceFilterType::Pointer distanceFilter = newDistanceFilter();
+
+  // The skeletonizer runs in place
+  ImageType::Pointer copy = copyImage(object);
+
+  SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+  skeletonizer->SetInput(copy);
+  skeletonizer->SetForegroundValue(255);
+  skeletonizer->SetDistanceFilter(distanceFilter);
+  if(numberOfThreads != 0)
+    {
+    skeletonizer->SetComponentwise(true);
+    skeletonizer->SetNumberOfThreads(numberOfThreads);
+    }
+  skeletonizer->Update();
+  return skeletonizer->GetOutput();
+  }
+
+
+int main(int, char**)
+{
+  ImageType::Pointer object = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill(40);
+  object->SetRegions(size);
+  object->Allocate();
+  object->FillBuffer(0);
+
+  // Blocks touching a face, and a corner, of the image
+  setBox(object, 0, 9, 5, 14, 5, 14, 255);
+  setBox(object, 30, 39, 30, 39, 0, 9, 255);
+
+  // A thick frame, with a block in its hole, and an L above the frame with
+  // a leg along its side : the bounding boxes of the 3 components overlap.
+  setBox(object, 14, 34, 14, 34, 14, 20, 255);
+  setBox(object, 18, 30, 18, 30, 14, 20, 0);
+  setBox(object, 22, 26, 22, 26, 12, 22, 255);
+  setBox(object, 12, 37, 24, 25, 24, 26, 255);
+  setBox(object, 36, 37, 24, 25, 14, 26, 255);
+
+  // A slab through the whole image
+  setBox(object, 0, 39, 0, 39, 33, 36, 255);
+
+  ImageType::Pointer const expected = skeletonize(object, 0);
+
+  unsigned int errors = 0;
+  unsigned int const threads[] = { 1, 2, 4, 16 };
+  for(unsigned int i = 0; i < sizeof(threads)/sizeof(threads[0]); ++i)
+    {
+    ImageType::Pointer const skeleton = skeletonize(object, threads[i]);
+    if(!sameImages(skeleton, expected))
+      {
+      std::cerr << "wrong skeleton with " << threads[i] << " threads"
+                << std::endl;
+      ++errors;
+      }
+    }
+
+  // Check that the skeleton is not the object itself
+  errors += check(!sameImages(expected, object), "object not thinned");
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #include "itkIndex.h"
 #include "itkContinuousIndex.h"
 #include "itkImageBase.h"
+#include "itkNeighborhoodConfiguration.h"
 
 namespace itk
 {
@@ -103,12 +104,55 @@ public:
   itkGetMacro(ForegroundValue, InputPixelType);
   virtual void SetForegroundValue(const InputPixelType &);
 
+  /** Type of the packed configuration of the neighborhood of a point. */
+  typedef NeighborhoodConfiguration<InputImageType> NeighborhoodConfigurationType;
+  typedef typename NeighborhoodConfigurationType::ConfigurationType ConfigurationType;
+
+  /** Get the gatherer of the configurations around the points of the input
+   * image, e.g. to share a configuration between several functions. */
+  const NeighborhoodConfigurationType & GetNeighborhoodConfiguration() const
+    { return m_NeighborhoodConfiguration; }
+
+  /** Set the input image, and the image of the neighborhood configuration. */
+  virtual void SetInputImage( const InputImageType * ptr );
+
+  /** Offset of a point in the buffer of the input image. */
+  typedef typename InputImageType::OffsetValueType OffsetValueType;
+
+  /** Number of points processed at once by the batch evaluations. */
+  itkStaticConstMacro(BatchSize, unsigned int, 64);
+
+  /** Evaluate the function at count points given by their offsets in the
+   * buffer of the input image, and store the values in results. The
+   * default calls EvaluateAtIndex for each point ; subclasses override it
+   * to hoist the buffer and the neighborhood offsets out of the loop. */
+  virtual void EvaluateAtOffsets( const OffsetValueType * offsets,
+                                  unsigned long count,
+                                  OutputType * results ) const;
+
+  /** Evaluate the function at count indices, and store the values in
+   * results. The default calls EvaluateAtIndex for each point ; the
+   * subclasses overriding EvaluateAtOffsets override it with
+   * EvaluateAtIndicesByOffsets. */
+  virtual void EvaluateAtIndices( const IndexType * indices,
+                                  unsigned long count,
+                                  OutputType * results ) const;
+
 protected:
   BinaryImageFunction();
   ~BinaryImageFunction() {}
   void PrintSelf(std::ostream& os, Indent indent) const;
 
+  /** Convert the indices to offsets by batches, and evaluate them with
+   * EvaluateAtOffsets. */
+  void EvaluateAtIndicesByOffsets( const IndexType * indices,
+                                   unsigned long count,
+                                   OutputType * results ) const;
+
   InputPixelType m_ForegroundValue;
+
+  /** Gathers the foreground points around a point of the input image. */
+  NeighborhoodConfigurationType m_NeighborhoodConfiguration;
   
 private:
   BinaryImageFunction(const Self&); //purposely not implemented
@@ -17,6 +17,8 @@
 #ifndef __itkBinaryImageFunction_txx
 #define __itkBinaryImageFunction_txx
 
+#include <algorithm>
+
 #include "itkBinaryImageFunction.h"
 
 namespace itk
@@ -59,6 +61,63 @@ BinaryImageFunction<TInputImage, TOutput, TCoordRep>
 
 
 
+template <class TInputImage, class TOutput, class TCoordRep>
+void
+BinaryImageFunction<TInputImage, TOutput, TCoordRep>
+::SetInputImage( const InputImageType * ptr )
+{
+  Superclass::SetInputImage( ptr );
+  m_NeighborhoodConfiguration.SetImage( ptr );
+}
+
+
+template <class TInputImage, class TOutput, class TCoordRep>
+void
+BinaryImageFunction<TInputImage, TOutput, TCoordRep>
+::EvaluateAtOffsets( const OffsetValueType * offsets, unsigned long count,
+                     OutputType * results ) const
+{
+  const InputImageType * image = this->GetInputImage();
+  for( unsigned long i = 0; i < count; ++i )
+    {
+    results[i] = this->EvaluateAtIndex( image->ComputeIndex( offsets[i] ) );
+    }
+}
+
+
+template <class TInputImage, class TOutput, class TCoordRep>
+void
+BinaryImageFunction<TInputImage, TOutput, TCoordRep>
+::EvaluateAtIndices( const IndexType * indices, unsigned long count,
+                     OutputType * results ) const
+{
+  for( unsigned long i = 0; i < count; ++i )
+    {
+    results[i] = this->EvaluateAtIndex( indices[i] );
+    }
+}
+
+
+template <class TInputImage, class TOutput, class TCoordRep>
+void
+BinaryImageFunction<TInputImage, TOutput, TCoordRep>
+::EvaluateAtIndicesByOffsets( const IndexType * indices, unsigned long count,
+                              OutputType * results ) const
+{
+  const InputImageType * image = this->GetInputImage();
+  OffsetValueType offsets[BatchSize];
+  for( unsigned long batch = 0; batch < count; batch += BatchSize )
+    {
+    const unsigned long batchCount =
+      std::min<unsigned long>( BatchSize, count - batch );
+    for( unsigned long i = 0; i < batchCount; ++i )
+      {
+      offsets[i] = image->ComputeOffset( indices[batch+i] );
+      }
+    this->EvaluateAtOffsets( offsets, batchCount, results + batch );
+    }
+}
+
 } // end namespace itk
 
 #endif
@@ -2,9 +2,11 @@
 #define itkChamferDistanceTransformImageFilter_h
 
 #include <iosfwd>
+#include <utility>
 #include <vector>
 
 #include <itkImageToImageFilter.h>
+#include <itkMultiThreader.h>
 
 namespace itk
 {
@@ -15,6 +17,23 @@ namespace itk
  * This is the two pass algorithm of Borgefors in "On digital distance 
  * transforms in three dimensions", Computer Vision and Image Understanding
  * 64(3), pp. 368--376, 1996.
+ *
+ * The passes are split across the threads of the filter with a wavefront 
+ * schedule : the hyperplanes orthogonal to the last axis are dealt 
+ * round-robin to the threads, and each thread scans its hyperplane in 
+ * segments of lines, waiting for the segments of the previous hyperplanes 
+ * that the mask reaches. Every point is thus updated with the same values as
+ * in the sequential scan, and the result does not depend on the number of
+ * threads.
+ *
+ * The distances are computed in the pixel type of the output, and saturate
+ * to its maximum : the points farther than the range of the type all get the
+ * maximum. An 8 or 16 bits output thus holds the exact distances of thin
+ * objects, and a coarse ordering of the thick ones, in a quarter or a half of
+ * the memory of a 32 bits output.
+ *
+ * After an edit of the input, UpdateDistances brings a distance map computed
+ * with the same parameters up to date without running the whole transform.
  */
 template<typename InputImage, typename OutputImage>
 class ITK_EXPORT ChamferDistanceTransformImageFilter : 
@@ -46,6 +65,11 @@ class ITK_EXPORT ChamferDistanceTransformImageFilter :
     
     /** Declaration of pixel type. */
     typedef typename InputImageType::PixelType InputPixelType ;
+    typedef typename OutputImageType::PixelType OutputPixelType;
+    typedef typename OutputImageType::IndexType IndexType;
+    typedef typename OutputImageType::OffsetType OffsetType;
+    typedef typename OutputImageType::OffsetValueType OffsetValueType;
+    typedef typename OutputImageType::RegionType RegionType;
 
     /**
      * @brief Initializes the filter.
@@ -71,18 +95,184 @@ class ITK_EXPORT ChamferDistanceTransformImageFilter :
      * @brief Return the weights used in the distance transform.
      */
     std::vector<typename OutputImage::PixelType> GetWeights() const;
+
+    /** @brief Largest radius of the mask, along each axis. */
+    itkStaticConstMacro(MaximumRadius, unsigned int, 2);
+    
+    /**
+     * @brief Set the weight of an offset and of its opposite in the mask.
+     *
+     * The mask is made of the points of the unit cube, weighted according to
+     * SetWeights, and of the offsets set by this function, which override 
+     * the former. Setting offsets with a coordinate equal to 2 enlarges the 
+     * mask to a radius of 2, e.g. to use the 5-7-11 mask in 2D, set the 
+     * weights to (5, 7) and the weight of (1, 2), (2, 1), (-1, 2) and (-2, 1)
+     * to 11.
+     *
+     * @pre The coordinates of the offset must be between -MaximumRadius and 
+     * MaximumRadius, and not all null.
+     */
+    void SetOffsetWeight(OffsetType const & offset, OutputPixelType weight);
+    
+    /** @brief Remove the weights set by SetOffsetWeight. */
+    void ClearOffsetWeights();
     
     itkSetMacro(ForegroundValue, InputPixelType);
     itkGetMacro(ForegroundValue, InputPixelType);
+    
+    /**
+     * @name Multi-label mode
+     *
+     * When MultiLabel is set, the distance is computed in all the labels, 
+     * i.e. the points different from BackgroundValue : the foreground value
+     * and DistanceFromObject are not used. Defaults to false, the background
+     * value defaults to 0.
+     */
+    //@{
+    itkSetMacro(MultiLabel, bool);
+    itkGetConstMacro(MultiLabel, bool);
+    itkBooleanMacro(MultiLabel);
+    
+    itkSetMacro(BackgroundValue, InputPixelType);
+    itkGetMacro(BackgroundValue, InputPixelType);
+    //@}
+    
+    /** @brief List of points, given by their offsets in the output buffer. */
+    typedef std::vector<OffsetValueType> PointListType;
+    
+    /**
+     * @name List of the points with a non-null distance
+     *
+     * When ListNonNullPoints is set, the points with a non-null distance are
+     * listed in raster order during the backward pass, e.g. to initialize 
+     * the queue of SkeletonizeImageFilter without scanning the output again.
+     * Defaults to false.
+     */
+    //@{
+    itkSetMacro(ListNonNullPoints, bool);
+    itkGetConstMacro(ListNonNullPoints, bool);
+    itkBooleanMacro(ListNonNullPoints);
+    
+    PointListType const & GetNonNullPoints() const;
+    
+    /** @brief Free the list of points. */
+    void ReleaseNonNullPoints();
+    //@}
+    
+    /**
+     * @brief Update a distance map computed with the parameters of this 
+     * filter, after its input was edited in dirtyRegion. Return the region 
+     * where the distances may have changed, in the index space of the input.
+     *
+     * A point outside of the edit changes only if its nearest point in the 
+     * old or new input is in the edit, i.e. if its distance to the edit is at
+     * most its old distance. These points are found by a propagation of the 
+     * distance to the edit, in a HierarchicalQueue, through the points where
+     * it is at most the old distance : each of them is reached through such 
+     * points. Both passes are then run on their bounding box only, the 
+     * distances around it being up to date. The cost grows with the size of 
+     * this box, not with the size of the image, and the result is the same as
+     * a new transform. The list of non-null points is not updated. The 
+     * distances to the edit are kept in a hash map local to the call, which 
+     * only holds the points reached : concurrent calls on different maps are
+     * safe.
+     *
+     * @pre The distance map must have the size of the buffered region of the
+     * input ; its buffer shares the offsets of the input buffer.
+     */
+    RegionType UpdateDistances(InputImageType const * input, 
+                               OutputImageType * distance, 
+                               RegionType const & dirtyRegion) const;
 
   protected :
     void PrintSelf(std::ostream& os, Indent indent) const;
     
+    /** 
+     * @name The distance is global : the whole input is needed, and the 
+     * whole output is produced.
+     */
+    //@{
+    void GenerateInputRequestedRegion();
+    void EnlargeOutputRequestedRegion(DataObject * output);
+    //@}
+    
     void GenerateData();    
 
   private :
+    /** @brief Point of a half mask. */
+    struct MaskPoint
+      {
+      OffsetType Offset;
+      OffsetValueType BufferOffset;
+      OutputPixelType Weight;
+      };
+    
+    typedef std::vector<MaskPoint> HalfMaskType;
+    
+    /** 
+     * @brief Split the mask in its half before the center in the scan order,
+     * and its half after the center, with the offsets in the buffer of image.
+     * Return the radius of the mask.
+     */
+    long BuildHalfMasks(OutputImageType const * image, 
+                        HalfMaskType & backwardMask, 
+                        HalfMaskType & forwardMask) const;
+    
+    /** @brief Parameters of a pass, shared by the threads. */
+    struct ChamferPassStruct
+      {
+      Self const * Filter;
+      /** @brief Distance map, the output or the map of UpdateDistances. */
+      OutputImageType * Output;
+      HalfMaskType const * Mask;
+      bool Forward;
+      long Radius;
+      OutputPixelType BoundaryValue;
+      std::vector<unsigned long> * Progress;
+      /** @brief Non-null points of each hyperplane, or 0. */
+      std::vector<PointListType> * NonNullPoints;
+      /** @brief Buffer of the labels in multi-label mode, or 0. */
+      InputPixelType const * Labels;
+      };
+    
+    /** @brief Number of points in the segments of lines scanned at once. */
+    itkStaticConstMacro(SegmentLength, unsigned long, 64);
+    
+    static ITK_THREAD_RETURN_TYPE ChamferPassThreaderCallback(void * arg);
+    
+    /** 
+     * @brief Scan the hyperplanes threadId, threadId+numberOfThreads, ... in 
+     * the order of the pass.
+     */
+    void ChamferPass(ChamferPassStruct const & pass, 
+                     unsigned int threadId, unsigned int numberOfThreads) const;
+    
+    /** 
+     * @brief Update the points of the line starting at index, from 
+     * index[0] to end (excluded) in the order of the pass.
+     */
+    void ChamferSegment(ChamferPassStruct const & pass, 
+                        IndexType index, long end) const;
+    
+    /** 
+     * @name Progress of the hyperplanes
+     *
+     * The progress of a hyperplane is written by its thread after the 
+     * segments, and read by the other threads before they read the points.
+     */
+    //@{
+    static unsigned long GetProgress(unsigned long const & progress);
+    static void SetProgress(unsigned long & progress, unsigned long value);
+    
+    /** @brief Let the other threads run while waiting for a hyperplane. */
+    static void YieldThread();
+    //@}
+    
     typename OutputImage::PixelType m_Weights[OutputImage::ImageDimension];
     
+    /** @brief Weights of the offsets set by SetOffsetWeight. */
+    std::vector<std::pair<OffsetType, OutputPixelType> > m_OffsetWeights;
+    
     ChamferDistanceTransformImageFilter(Self const &); // not implemented
     Self & operator=(Self const &); // not implemented
 
@@ -105,6 +295,13 @@ class ITK_EXPORT ChamferDistanceTransformImageFilter :
     bool m_DistanceFromObject;
     
     InputPixelType m_ForegroundValue;
+    
+    bool m_MultiLabel;
+    InputPixelType m_BackgroundValue;
+    
+    bool m_ListNonNullPoints;
+    PointListType m_NonNullPoints;
+
   };
 
 }
@@ -2,17 +2,26 @@
 #define itkChamferDistanceTransformImageFilter_txx
 
 #include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <vector>
 
-#include <itkConstantBoundaryCondition.h>
+#if defined(_WIN32)
+#include "itkWindows.h"
+#else
+#include <sched.h>
+#endif
+
 #include <itkImageRegionIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 #include <itkNeighborhood.h>
-#include <itkNeighborhoodIterator.h>
 #include <itkNumericTraits.h>
-
+#include <itk_hash_map.h>
 
 #include "itkChamferDistanceTransformImageFilter.h"
+#include "itkHierarchicalQueue.h"
 
 namespace itk
 {
@@ -24,6 +33,9 @@ ChamferDistanceTransformImageFilter<InputImage, OutputImage>
   std::fill(m_Weights, m_Weights+OutputImage::ImageDimension, 1);
   m_ForegroundValue = NumericTraits<InputPixelType>::max();
   m_DistanceFromObject = false;
+  m_MultiLabel = false;
+  m_BackgroundValue = NumericTraits<InputPixelType>::Zero;
+  m_ListNonNullPoints = false;
   }
 
 
@@ -50,6 +62,84 @@ ChamferDistanceTransformImageFilter<InputImage, OutputImage>
   return result;
   }
 
+template<typename InputImage, typename OutputImage>
+void 
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::SetOffsetWeight(OffsetType const & offset, OutputPixelType weight)
+  {
+  OffsetType opposite;
+  bool isNull = true;
+  for(unsigned int i=0; i<OutputImage::ImageDimension; ++i)
+    {
+    opposite[i] = -offset[i];
+    if(offset[i] < -long(MaximumRadius) || offset[i] > long(MaximumRadius))
+      {
+      itkExceptionMacro(<< "Offset " << offset << " is outside of the mask");
+      }
+    if(offset[i] != 0)
+      {
+      isNull = false;
+      }
+    }
+  if(isNull)
+    {
+    itkExceptionMacro(<< "The center of the mask has no weight");
+    }
+  
+  OffsetType const * const offsets[2] = { &offset, &opposite };
+  for(unsigned int i=0; i<2; ++i)
+    {
+    typename std::vector<std::pair<OffsetType, OutputPixelType> >::iterator 
+      it = m_OffsetWeights.begin();
+    while(it != m_OffsetWeights.end() && it->first != *offsets[i])
+      {
+      ++it;
+      }
+    if(it == m_OffsetWeights.end())
+      {
+      m_OffsetWeights.push_back(std::make_pair(*offsets[i], weight));
+      }
+    else
+      {
+      it->second = weight;
+      }
+    }
+  this->Modified();
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void 
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::ClearOffsetWeights()
+  {
+  if(!m_OffsetWeights.empty())
+    {
+    m_OffsetWeights.clear();
+    this->Modified();
+    }
+  }
+
+
+template<typename InputImage, typename OutputImage>
+typename ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+  ::PointListType const &
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::GetNonNullPoints() const
+  {
+  return m_NonNullPoints;
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void 
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::ReleaseNonNullPoints()
+  {
+  PointListType().swap(m_NonNullPoints);
+  }
+
+
 template<typename InputImage, typename OutputImage>
 void 
 ChamferDistanceTransformImageFilter<InputImage, OutputImage>
@@ -62,8 +152,42 @@ ChamferDistanceTransformImageFilter<InputImage, OutputImage>
     os << m_Weights[i] << " ";
     }
   os << "]" << "\n";
+  os << indent << "Offset weights : [ ";
+  for(unsigned int i=0; i<m_OffsetWeights.size(); ++i)
+    {
+    os << m_OffsetWeights[i].first << ":" << m_OffsetWeights[i].second << " ";
+    }
+  os << "]" << "\n";
   os << indent << "Distance from object : " << m_DistanceFromObject << "\n";
   os << indent << "ForegroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_ForegroundValue) << std::endl;
+  os << indent << "MultiLabel: " << m_MultiLabel << std::endl;
+  os << indent << "BackgroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "List non-null points : " << m_ListNonNullPoints << "\n";
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::GenerateInputRequestedRegion()
+  {
+  Superclass::GenerateInputRequestedRegion();
+  
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if(input)
+    {
+    input->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::EnlargeOutputRequestedRegion(DataObject * output)
+  {
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
   }
 
 
@@ -89,9 +213,10 @@ ChamferDistanceTransformImageFilter<InputImage, OutputImage>
   // Initialize output image : \infty where input is not 0, 0 where input is 0 
 
   // if computing the distance from the object, the opposite otherwise.
+  // In multi-label mode, the distance is computed in the labels.
   typename OutputImageType::PixelType const fgValue = 
 
-    m_DistanceFromObject?
+    (m_DistanceFromObject && !m_MultiLabel)?
 
       0:NumericTraits<typename OutputImageType::PixelType>::max();
   typename OutputImageType::PixelType const bgValue = 
@@ -106,9 +231,12 @@ ChamferDistanceTransformImageFilter<InputImage, OutputImage>
     outputImageIt(this->GetOutput(), this->GetOutput()->GetRequestedRegion());
   while(!outputImageIt.IsAtEnd())
     {
+    bool const inObject = m_MultiLabel ? 
+      (inputImageIt.Get() != m_BackgroundValue) : 
+      (inputImageIt.Get() == m_ForegroundValue);
     typename OutputImageType::PixelType const value = 
 
-      (inputImageIt.Get() == m_ForegroundValue) ? 
+      inObject ? 
 
         fgValue : bgValue;
     outputImageIt.Set(value);
@@ -117,111 +245,650 @@ ChamferDistanceTransformImageFilter<InputImage, OutputImage>
     ++outputImageIt;
     }
     
-  // Create the mask of the weights
-  Neighborhood<typename OutputImageType::PixelType, 
+  HalfMaskType backwardMask;
+  HalfMaskType forwardMask;
+  long const radius = 
+    this->BuildHalfMasks(outputImage, backwardMask, forwardMask);
+  
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
+  if(OutputImageType::ImageDimension == 1)
+    {
+    numberOfThreads = 1;
+    }
+  else
+    {
+    unsigned long const numberOfPlanes = 
+      size[OutputImageType::ImageDimension-1];
+    numberOfThreads = std::min<unsigned long>(numberOfThreads, numberOfPlanes);
+    }
+  
+  // The non-null points are listed per hyperplane by the backward pass, so
+  // that the threads do not share a list.
+  this->ReleaseNonNullPoints();
+  std::vector<PointListType> nonNullPoints;
+  if(m_ListNonNullPoints)
+    {
+    nonNullPoints.resize((OutputImageType::ImageDimension == 1) ? 
+      1 : size[OutputImageType::ImageDimension-1]);
+    }
+  
+  // First pass : forward scan, use backward mask. Second pass : backward 
+  // scan, use forward mask.
+  for(unsigned int passNumber=0; passNumber<2; ++passNumber)
+    {
+    std::vector<unsigned long> progress(
+      (OutputImageType::ImageDimension == 1) ? 
+        1 : size[OutputImageType::ImageDimension-1], 0);
+    
+    ChamferPassStruct pass;
+    pass.Filter = this;
+    pass.Output = outputImage;
+    pass.Mask = (passNumber == 0) ? &backwardMask : &forwardMask;
+    pass.Forward = (passNumber == 0);
+    pass.Radius = radius;
+    pass.BoundaryValue = bgValue;
+    pass.Progress = &progress;
+    pass.NonNullPoints = 
+      (passNumber == 1 && m_ListNonNullPoints) ? &nonNullPoints : 0;
+    pass.Labels = m_MultiLabel ? this->GetInput()->GetBufferPointer() : 0;
+    
+    if(numberOfThreads <= 1)
+      {
+      this->ChamferPass(pass, 0, 1);
+      }
+    else
+      {
+      this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+      this->GetMultiThreader()->SetSingleMethod(
+        this->ChamferPassThreaderCallback, &pass);
+      this->GetMultiThreader()->SingleMethodExecute();
+      }
+    }
+  
+  // Each hyperplane was listed in decreasing order of offset.
+  if(m_ListNonNullPoints)
+    {
+    unsigned long numberOfPoints = 0;
+    for(unsigned long i=0; i<nonNullPoints.size(); ++i)
+      {
+      numberOfPoints += nonNullPoints[i].size();
+      }
+    m_NonNullPoints.reserve(numberOfPoints);
+    for(unsigned long i=0; i<nonNullPoints.size(); ++i)
+      {
+      m_NonNullPoints.insert(m_NonNullPoints.end(), 
+        nonNullPoints[i].rbegin(), nonNullPoints[i].rend());
+      PointListType().swap(nonNullPoints[i]);
+      }
+    }
+  }
 
-               OutputImageType::ImageDimension> mask;
-  mask.SetRadius(1);
+
+template<typename InputImage, typename OutputImage>
+typename ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+  ::RegionType
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::UpdateDistances(InputImageType const * input, OutputImageType * distance, 
+                  RegionType const & dirtyRegion) const
+  {
+  typename InputImageType::RegionType const & inputRegion = 
+    input->GetBufferedRegion();
+  RegionType const & region = distance->GetBufferedRegion();
+  if(inputRegion.GetSize() != region.GetSize())
+    {
+    itkExceptionMacro(<< "Distance map buffered region " << region
+                      << " differs from input buffered region " 
+                      << inputRegion);
+    }
+  
+  // Work in the index space of the distance map
+  RegionType dirty = dirtyRegion;
+  IndexType dirtyIndex = dirtyRegion.GetIndex();
+  for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
+    {
+    dirtyIndex[j] += region.GetIndex()[j] - inputRegion.GetIndex()[j];
+    }
+  dirty.SetIndex(dirtyIndex);
+  if(dirty.GetNumberOfPixels() == 0 || !dirty.Crop(region))
+    {
+    return RegionType();
+    }
+  
+  HalfMaskType backwardMask;
+  HalfMaskType forwardMask;
+  long const radius = 
+    this->BuildHalfMasks(distance, backwardMask, forwardMask);
+  HalfMaskType mask(backwardMask);
+  mask.insert(mask.end(), forwardMask.begin(), forwardMask.end());
+  
+  OutputPixelType * const buffer = distance->GetBufferPointer();
+  InputPixelType const * const labels = input->GetBufferPointer();
+  OutputPixelType const infinity = NumericTraits<OutputPixelType>::max();
+  
+  // Propagate the distance to the edit through the points where it is at 
+  // most the old distance, and bound them. The distances to the edit are 
+  // kept in a hash map, the points missing from it holding the maximum : the
+  // points reached with the maximum are not propagated, their distance being
+  // saturated before and after the edit.
+  typedef HierarchicalQueue<OutputPixelType, OffsetValueType, 
+                            std::less<OutputPixelType> > QueueType;
+  typedef hash_map<OffsetValueType, OutputPixelType> ReachedMapType;
+  QueueType q;
+  ReachedMapType reached;
+  for(ImageRegionConstIteratorWithIndex<OutputImageType> it(distance, dirty);
+      !it.IsAtEnd(); ++it)
+    {
+    OffsetValueType const offset = distance->ComputeOffset(it.GetIndex());
+    reached[offset] = 0;
+    q.Push(0, offset);
+    }
+  
+  IndexType first = dirty.GetIndex();
+  IndexType last = first;
+  for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
+    {
+    last[j] += dirty.GetSize()[j] - 1;
+    }
+  while(!q.Empty())
+    {
+    OutputPixelType const value = q.FrontKey();
+    OffsetValueType const offset = q.FrontValue();
+    q.Pop();
+    if(reached.find(offset)->second != value)
+      {
+      // Reached again with a lower distance
+      continue;
+      }
+    
+    IndexType const index = distance->ComputeIndex(offset);
+    for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
+      {
+      first[j] = std::min(first[j], index[j]);
+      last[j] = std::max(last[j], index[j]);
+      }
+    
+    for(typename HalfMaskType::const_iterator it=mask.begin(); 
+        it != mask.end(); ++it)
+      {
+      if(!region.IsInside(index + it->Offset))
+        {
+        continue;
+        }
+      OffsetValueType const neighbor = offset + it->BufferOffset;
+      OutputPixelType const neighborValue = 
+        (value < infinity - it->Weight) ? value + it->Weight : infinity;
+      if(neighborValue > buffer[neighbor])
+        {
+        continue;
+        }
+      typename ReachedMapType::iterator const reachedIt = 
+        reached.find(neighbor);
+      if(reachedIt == reached.end())
+        {
+        if(neighborValue == infinity)
+          {
+          continue;
+          }
+        reached.insert(std::make_pair(neighbor, neighborValue));
+        }
+      else if(neighborValue < reachedIt->second)
+        {
+        reachedIt->second = neighborValue;
+        }
+      else
+        {
+        continue;
+        }
+      q.Push(neighborValue, neighbor);
+      }
+    }
+  
+  RegionType changed;
+  changed.SetIndex(first);
+  typename RegionType::SizeType changedSize;
+  for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
+    {
+    changedSize[j] = last[j] - first[j] + 1;
+    }
+  changed.SetSize(changedSize);
+  
+  // Initialize the box as the whole output in GenerateData, and run both 
+  // passes on its lines, in the scan order.
+  typename OutputImageType::PixelType const fgValue = 
+    (m_DistanceFromObject && !m_MultiLabel) ? 0 : infinity;
+  typename OutputImageType::PixelType const bgValue = infinity - fgValue;
+  for(ImageRegionIteratorWithIndex<OutputImageType> it(distance, changed);
+      !it.IsAtEnd(); ++it)
+    {
+    InputPixelType const label = 
+      labels[distance->ComputeOffset(it.GetIndex())];
+    bool const inObject = m_MultiLabel ? (label != m_BackgroundValue) : 
+                                         (label == m_ForegroundValue);
+    it.Set(inObject ? fgValue : bgValue);
+    }
+  
+  long const width = changedSize[0];
+  long numberOfLines = 1;
+  for(unsigned int d=1; d<OutputImageType::ImageDimension; ++d)
+    {
+    numberOfLines *= changedSize[d];
+    }
+  for(unsigned int passNumber=0; passNumber<2; ++passNumber)
+    {
+    ChamferPassStruct pass;
+    pass.Filter = this;
+    pass.Output = distance;
+    pass.Mask = (passNumber == 0) ? &backwardMask : &forwardMask;
+    pass.Forward = (passNumber == 0);
+    pass.Radius = radius;
+    pass.BoundaryValue = bgValue;
+    pass.Progress = 0;
+    pass.NonNullPoints = 0;
+    pass.Labels = m_MultiLabel ? labels : 0;
+    
+    for(long rank=0; rank<numberOfLines; ++rank)
+      {
+      long const line = pass.Forward ? rank : numberOfLines-1-rank;
+      IndexType index = first;
+      index[0] += pass.Forward ? 0 : width-1;
+      long remainder = line;
+      for(unsigned int d=1; d<OutputImageType::ImageDimension; ++d)
+        {
+        index[d] += remainder % changedSize[d];
+        remainder /= changedSize[d];
+        }
+      this->ChamferSegment(pass, index, 
+        first[0] + (pass.Forward ? width : -1));
+      }
+    }
+  
+  IndexType changedIndex = changed.GetIndex();
+  for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
+    {
+    changedIndex[j] += inputRegion.GetIndex()[j] - region.GetIndex()[j];
+    }
+  changed.SetIndex(changedIndex);
+  return changed;
+  }
+
+
+template<typename InputImage, typename OutputImage>
+long
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::BuildHalfMasks(OutputImageType const * image, HalfMaskType & backwardMask,
+                 HalfMaskType & forwardMask) const
+  {
+  // The points before the center in the scan order are used by the forward
+  // pass, the points after it by the backward pass. Only the points with a 
+  // weight are kept.
+  unsigned long radius = 1;
+  for(unsigned int i=0; i<m_OffsetWeights.size(); ++i)
+    {
+    for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
+      {
+      radius = std::max<unsigned long>(radius, 
+                                       std::abs(m_OffsetWeights[i].first[j]));
+      }
+    }
+  
+  OffsetValueType const * const offsetTable = image->GetOffsetTable();
+  Neighborhood<OutputPixelType, OutputImageType::ImageDimension> mask;
+  mask.SetRadius(radius);
   for(unsigned int i=0; i<mask.Size(); ++i)
     {
     // Skip center
     if(i == mask.Size()/2)
       {
-      mask[mask.Size()/2] = 
-
-        NumericTraits<typename OutputImageType::PixelType>::max();
       continue;
       }
     
-    Offset<OutputImageType::ImageDimension> const offset = mask.GetOffset(i);
+    MaskPoint point;
+    point.Offset = mask.GetOffset(i);
+    point.BufferOffset = 0;
     int type=-1;
+    bool inUnitCube = true;
     for(unsigned int j=0; j<OutputImageType::ImageDimension; ++j)
       {
-      if(offset[j]!=0)
+      point.BufferOffset += point.Offset[j]*offsetTable[j];
+      if(point.Offset[j]!=0)
         {
         ++type;
         }
+      if(std::abs(point.Offset[j]) > 1)
+        {
+        inUnitCube = false;
+        }
+      }
+    
+    bool hasWeight = inUnitCube;
+    if(inUnitCube)
+      {
+      point.Weight = m_Weights[type];
+      }
+    for(unsigned int j=0; j<m_OffsetWeights.size(); ++j)
+      {
+      if(m_OffsetWeights[j].first == point.Offset)
+        {
+        point.Weight = m_OffsetWeights[j].second;
+        hasWeight = true;
+        }
       }
-    mask[i] = m_Weights[type];
+    if(!hasWeight)
+      {
+      continue;
+      }
+    if(point.Weight >= NumericTraits<OutputPixelType>::max())
+      {
+      itkExceptionMacro(<< "Weight "
+        << static_cast<typename NumericTraits<OutputPixelType>::PrintType>(
+             point.Weight)
+        << " of offset " << point.Offset
+        << " saturates the output pixel type");
+      }
+
+    if(i < mask.Size()/2)
+      {
+      backwardMask.push_back(point);
+      }
+    else
+      {
+      forwardMask.push_back(point);
+      }
+    }
+  
+  return radius;
   }
+
+
+template<typename InputImage, typename OutputImage>
+ITK_THREAD_RETURN_TYPE
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::ChamferPassThreaderCallback(void * arg)
+  {
+  MultiThreader::ThreadInfoStruct * info = 
+    static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  ChamferPassStruct * pass = static_cast<ChamferPassStruct *>(info->UserData);
+  
+  pass->Filter->ChamferPass(*pass, info->ThreadID, info->NumberOfThreads);
+  
+  return ITK_THREAD_RETURN_VALUE;
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::ChamferPass(ChamferPassStruct const & pass, 
+              unsigned int threadId, unsigned int numberOfThreads) const
+  {
+  unsigned int const dimension = OutputImageType::ImageDimension;
+  typename OutputImageType::RegionType const & region = 
+    pass.Output->GetBufferedRegion();
+  typename OutputImageType::SizeType const & size = region.GetSize();
+  
+  // The image is scanned in hyperplanes along the last axis, each hyperplane
+  // in lines along the first axis, and each line in segments. The lines of a
+  // hyperplane are numbered with the first coordinate varying fastest.
+  long const width = size[0];
+  long const numberOfPlanes = (dimension == 1) ? 1 : size[dimension-1];
+  std::vector<long> lineStrides(dimension, 0);
+  long numberOfLines = 1;
+  for(unsigned int d=1; d+1<dimension; ++d)
+    {
+    lineStrides[d] = numberOfLines;
+    numberOfLines *= size[d];
+    }
+  long const segmentsPerLine = (width+SegmentLength-1)/SegmentLength;
+  long const numberOfSegments = numberOfLines*segmentsPerLine;
+  
+  // For each distance to the previous hyperplanes in the scan order, the
+  // farthest line of the mask in the scan order, and the farthest point on
+  // the first axis.
+  HalfMaskType const & mask = *pass.Mask;
+  long const radius = pass.Radius;
+  std::vector<long> reach(1, 0);
+  std::vector<bool> hasReach(1, false);
+  for(typename HalfMaskType::const_iterator it=mask.begin(); 
+      it != mask.end(); ++it)
+    {
+    if(dimension == 1 || it->Offset[dimension-1] == 0)
+      {
+      continue;
+      }
     
-    // Prepare the neighborhood iterator
-    typename NeighborhoodIterator<InputImageType>::RadiusType r;
-    r.Fill(1);
-    NeighborhoodIterator<OutputImageType> 
-
-      it(r, this->GetOutput(), this->GetOutput()->GetRequestedRegion());
-    ConstantBoundaryCondition<OutputImageType> bc;
-    bc.SetConstant(bgValue);
-    it.OverrideBoundaryCondition(&bc);
-    unsigned int const maskCenter = it.Size()/2;
+    long line = 0;
+    for(unsigned int d=1; d+1<dimension; ++d)
+      {
+      line += it->Offset[d]*lineStrides[d];
+      }
+    if(!pass.Forward)
+      {
+      line = -line;
+      }
     
-
-    // First pass : forward scan, use backward mask
-    it.GoToBegin();
+    unsigned long const distance = std::abs(it->Offset[dimension-1]);
+    if(distance >= reach.size())
+      {
+      reach.resize(distance+1, 0);
+      hasReach.resize(distance+1, false);
+      }
+    reach[distance] = hasReach[distance] ? std::max(reach[distance], line) 
+                                         : line;
+    hasReach[distance] = true;
+    }
+  
+  std::vector<unsigned long> & progress = *pass.Progress;
+  for(long rank=threadId; rank<numberOfPlanes; rank+=numberOfThreads)
+    {
+    long const plane = pass.Forward ? rank : numberOfPlanes-1-rank;
     
-    while(!it.IsAtEnd())
+    for(long segmentRank=0; segmentRank<numberOfSegments; ++segmentRank)
       {
-      typename OutputImageType::PixelType minimum = 
-
-        NumericTraits<typename OutputImageType::PixelType>::max();
-      for(unsigned int i=0; i<maskCenter; ++i)
+      long const segment = pass.Forward ? 
+        segmentRank : numberOfSegments-1-segmentRank;
+      long const line = segment / segmentsPerLine;
+      long const begin = (segment % segmentsPerLine)*SegmentLength;
+      long const end = std::min<long>(begin+SegmentLength, width);
+      
+      // Wait for the previous hyperplanes to be scanned up to the farthest 
+      // point of the mask.
+      for(unsigned long distance=1; distance<reach.size(); ++distance)
         {
-        if(it.GetPixel(i) < 
-
-           NumericTraits<typename OutputImageType::PixelType>::max() - mask[i])
+        if(!hasReach[distance] || rank < long(distance))
+          {
+          continue;
+          }
+        
+        long const otherLine = pass.Forward ? 
+          line+reach[distance] : line-reach[distance];
+        long const x = pass.Forward ? 
+          std::min(end-1+radius, width-1) : std::max(begin-radius, 0L);
+        unsigned long required;
+        if(otherLine < 0)
+          {
+          required = pass.Forward ? 0 : numberOfSegments;
+          }
+        else if(otherLine >= numberOfLines)
           {
-          minimum = std::min(minimum, it.GetPixel(i) + mask[i]);
+          required = pass.Forward ? numberOfSegments : 0;
+          }
+        else
+          {
+          long const otherSegment = 
+            otherLine*segmentsPerLine + x/SegmentLength;
+          required = pass.Forward ? 
+            otherSegment+1 : numberOfSegments-otherSegment;
+          }
+        
+        long const otherPlane = pass.Forward ? 
+          plane-long(distance) : plane+long(distance);
+        while(GetProgress(progress[otherPlane]) < required)
+          {
+          YieldThread();
           }
         }
-      if(minimum < it.GetCenterPixel())
+      
+      IndexType index = region.GetIndex();
+      index[0] += pass.Forward ? begin : end-1;
+      long remainder = line;
+      for(unsigned int d=1; d+1<dimension; ++d)
         {
-        it.SetCenterPixel(minimum);
+        index[d] += remainder % size[d];
+        remainder /= size[d];
         }
+      if(dimension > 1)
+        {
+        index[dimension-1] += plane;
+        }
+      this->ChamferSegment(pass, index, 
+        region.GetIndex()[0] + (pass.Forward ? end : begin-1));
       
-      
-      ++it;
+      SetProgress(progress[plane], segmentRank+1);
       }
-    
-    // Second pass : bacward scan, use forward mask
-    it.GoToEnd();
-    --it;
-    while(!it.IsAtBegin())
-      {
-      typename OutputImageType::PixelType minimum = 
+    }
+  }
 
-        NumericTraits<typename OutputImageType::PixelType>::max();
-      for(unsigned int i=maskCenter+1; i<it.Size(); ++i)
-        {
-        if(it.GetPixel(i) < 
 
-           NumericTraits<typename OutputImageType::PixelType>::max() - mask[i])
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::ChamferSegment(ChamferPassStruct const & pass, IndexType index, 
+                 long end) const
+  {
+  unsigned int const dimension = OutputImageType::ImageDimension;
+  OutputImageType * const output = pass.Output;
+  typename OutputImageType::RegionType const & region = 
+    output->GetBufferedRegion();
+  OutputPixelType * const buffer = output->GetBufferPointer();
+  OutputPixelType const infinity = NumericTraits<OutputPixelType>::max();
+  HalfMaskType const & mask = *pass.Mask;
+  long const step = pass.Forward ? 1 : -1;
+  // The input buffer holds the whole image, as the output : the offsets of 
+  // the points are the same in both buffers.
+  InputPixelType const * const labels = pass.Labels;
+  
+  // Range of the first coordinate where the whole mask is in the image, 
+  // empty if the rest of the mask is not.
+  long const radius = pass.Radius;
+  long insideBegin = region.GetIndex()[0] + radius;
+  long insideEnd = region.GetIndex()[0] + long(region.GetSize()[0]) - radius;
+  for(unsigned int d=1; d<dimension; ++d)
+    {
+    if(index[d] < region.GetIndex()[d] + radius || 
+       index[d] >= region.GetIndex()[d] + long(region.GetSize()[d]) - radius)
+      {
+      insideEnd = insideBegin;
+      }
+    }
+  
+  // The second pass sets the final distances : list the non-null ones in the
+  // hyperplane of the segment.
+  PointListType * nonNullPoints = 0;
+  if(pass.NonNullPoints)
+    {
+    nonNullPoints = &(*pass.NonNullPoints)[
+      (dimension == 1) ? 0 : index[dimension-1]-region.GetIndex()[dimension-1]];
+    }
+  
+  OffsetValueType offset = output->ComputeOffset(index);
+  for(; index[0] != end; index[0] += step, offset += step)
+    {
+    OutputPixelType minimum = infinity;
+    bool const inside = (index[0] >= insideBegin && index[0] < insideEnd);
+    for(typename HalfMaskType::const_iterator it=mask.begin(); 
+        it != mask.end(); ++it)
+      {
+      OutputPixelType value;
+      if(inside || region.IsInside(index + it->Offset))
+        {
+        value = buffer[offset + it->BufferOffset];
+        // The points of the other labels are at a null distance
+        if(labels && labels[offset + it->BufferOffset] != labels[offset])
           {
-          minimum = std::min(minimum, it.GetPixel(i) + mask[i]);
+          value = 0;
           }
         }
-      if(minimum < it.GetCenterPixel())
+      else
         {
-        it.SetCenterPixel(minimum);
+        value = pass.BoundaryValue;
         }
-      --it;
-      }
-    // Last pixel in the scan.
-    typename OutputImageType::PixelType minimum = 
-
-      NumericTraits<typename OutputImageType::PixelType>::max();
-    for(unsigned int i=maskCenter+1; i<it.Size(); ++i)
-      {
-      if(it.GetPixel(i) < NumericTraits<typename OutputImageType::PixelType>::max() - mask[i])
+      
+      if(value < infinity - it->Weight)
         {
-        minimum = std::min(minimum, it.GetPixel(i) + mask[i]);
+        minimum = std::min<OutputPixelType>(minimum, value + it->Weight);
         }
       }
-    if(minimum < it.GetCenterPixel())
+    if(minimum < buffer[offset])
       {
-      it.SetCenterPixel(minimum);
+      buffer[offset] = minimum;
       }
-    
+    if(nonNullPoints && buffer[offset] != 0)
+      {
+      nonNullPoints->push_back(offset);
+      }
+    }
+  }
+
+
+// The progress is read without lock : the points of a segment must be
+// written before its progress is published, and read after.
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+template<typename InputImage, typename OutputImage>
+unsigned long
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::GetProgress(unsigned long const & progress)
+  {
+  return __atomic_load_n(&progress, __ATOMIC_ACQUIRE);
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::SetProgress(unsigned long & progress, unsigned long value)
+  {
+  __atomic_store_n(&progress, value, __ATOMIC_RELEASE);
+  }
+#else
+template<typename InputImage, typename OutputImage>
+unsigned long
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::GetProgress(unsigned long const & progress)
+  {
+  unsigned long const value = 
+    *static_cast<unsigned long const volatile *>(&progress);
+#if defined(__GNUC__)
+  __sync_synchronize();
+#endif
+  return value;
+  }
+
+
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::SetProgress(unsigned long & progress, unsigned long value)
+  {
+#if defined(__GNUC__)
+  __sync_synchronize();
+#endif
+  *static_cast<unsigned long volatile *>(&progress) = value;
+  }
+#endif
+
+
+// The waiting threads give their processor to the others, which may be 
+// the ones they wait for when there are more threads than processors.
+template<typename InputImage, typename OutputImage>
+void
+ChamferDistanceTransformImageFilter<InputImage, OutputImage>
+::YieldThread()
+  {
+#if defined(_WIN32)
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
   }
 
 }
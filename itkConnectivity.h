@@ -2,6 +2,7 @@
 #define __itkConnectivity_h
 
 #include <itkObject.h>
+#include <itkFixedArray.h>
 #include <itkIndex.h>
 #include <itkOffset.h>
 #include <itkImage.h>
@@ -10,6 +11,29 @@
 namespace itk
 {
 
+/**
+ * @brief Number of points of the unit cube [-1, 1]^n with at least 
+ * VNumberOfZeros null coordinates, known at compile time.
+ *
+ * The points are counted according to their first coordinate : the points 
+ * with a null first coordinate need one less null coordinate in the other 
+ * dimensions.
+ */
+template<unsigned int VDimension, int VNumberOfZeros>
+struct UnitCubePointsCount
+  {
+  itkStaticConstMacro(Value, unsigned int, 
+    (UnitCubePointsCount<VDimension-1, VNumberOfZeros-1>::Value + 
+     2 * UnitCubePointsCount<VDimension-1, VNumberOfZeros>::Value));
+  };
+
+template<int VNumberOfZeros>
+struct UnitCubePointsCount<0, VNumberOfZeros>
+  {
+  itkStaticConstMacro(Value, unsigned int, (VNumberOfZeros <= 0) ? 1 : 0);
+  };
+
+
 /**
  * @brief Connectivity information.
  *
@@ -26,9 +50,101 @@ namespace itk
  * In 2D, 4- and 8-connectivity are respectively corresponding to 1- and
  * 0-connectivities. In 3D, 6-, 18- and 26-connectivity are respectively
  * corresponding to 2-, 1- and 0-connectivity.
+ *
+ * The connectivity is selected at compile time by VCellDimension : the 
+ * neighborhood is described by fixed-size tables, filled once in the 
+ * instance returned by GetInstance, and the membership of the points of the 
+ * unit cube is a bitmask of 3^n bits, so that IsInNeighborhood and 
+ * AreNeighbors are a single bit test. Points are given by their coordinates
+ * in [-1, 1]^n, or by their offset in the unit cube, the first coordinate 
+ * varying fastest.
+ *
+ * Connectivity<n> (VCellDimension equal to -1) is the connectivity selected
+ * at run time, created through the object factory.
+ *
+ * @pre VCellDimension < VDimension
+ */
+template<unsigned int VDimension, int VCellDimension = -1>
+class ITK_EXPORT Connectivity
+{
+public :
+  typedef Connectivity Self;
+
+  /// @brief The dimension of the space.
+  itkStaticConstMacro(Dimension, unsigned int, VDimension);
+
+  /// @brief The dimension of the cells shared by two neighbors.
+  itkStaticConstMacro(CellDimension, unsigned int, VCellDimension);
+
+  /// @brief Number of points in the unit cube.
+  itkStaticConstMacro(NeighborhoodSize, unsigned int, 
+                      (UnitCubePointsCount<VDimension, 0>::Value));
+
+  /// @brief Number of neighbors of a point.
+  itkStaticConstMacro(NumberOfNeighbors, unsigned int, 
+                      (UnitCubePointsCount<VDimension, VCellDimension>::Value - 1));
+
+  /// @brief Type for a point in the unit cube.
+  typedef FixedArray<int, VDimension> Point;
+
+  /// @brief Type for the offset of a point in the unit cube.
+  typedef int Offset;
+
+  /// @brief Return the unique instance of the connectivity.
+  static Self const & GetInstance();
+
+  int GetNeighborhoodSize() const;
+
+  int GetNumberOfNeighbors() const;
+
+  /// @brief Neighbors of 0, as points, in increasing order of offset.
+  Point const * GetNeighborsPoints() const;
+
+  /// @brief Neighbors of 0, as offsets, in increasing order.
+  Offset const * GetNeighborsOffsets() const;
+
+  /// @brief Test if a point of the unit cube is a neighbor of 0
+  bool IsInNeighborhood(Offset offset) const;
+
+  /// @brief Test if a point is a neighbor of 0
+  bool IsInNeighborhood(Point const & p) const;
+
+  /// @brief Test if two points are neighbors
+  bool AreNeighbors(Point const & p1, Point const & p2) const;
+
+  /// @brief Test if two points of the unit cube are neighbors
+  bool AreNeighbors(Offset o1, Offset o2) const;
+
+  static Offset PointToOffset(Point const & p);
+
+  static Point OffsetToPoint(Offset offset);
+
+private :
+  // Purposedly not implemeted
+  Connectivity(Self const & other);
+  Connectivity & operator=(Self const & other);
+
+  Connectivity();
+
+  itkStaticConstMacro(BitsPerWord, unsigned int, 8*sizeof(unsigned long));
+
+  Point m_NeighborsPoints[NumberOfNeighbors];
+  Offset m_NeighborsOffsets[NumberOfNeighbors];
+
+  /// @brief Bit i is set if the point of offset i is a neighbor of 0.
+  unsigned long m_Membership[(NeighborhoodSize + BitsPerWord - 1)/BitsPerWord];
+};
+
+
+/**
+ * @brief Connectivity selected at run time.
+ *
+ * The neighbors are computed when the cell dimension is set, and the 
+ * membership of the points of the unit cube is stored, so that 
+ * IsInNeighborhood and AreNeighbors are a single bit test.
  */
 template<unsigned int VDimension>
-class ITK_EXPORT Connectivity  : public LightObject
+class ITK_EXPORT Connectivity<VDimension, -1> : public LightObject
 {
 public :
 
@@ -235,6 +351,9 @@ private :
   /// @brief Neighbors.
   OffsetContainerType m_Neighbors;
 
+  /// @brief Element i is true if IntToOffset(i) is a neighbor of 0.
+  std::vector<bool> m_Membership;
+
   unsigned int m_CellDimension;
 
   static int m_GlobalDefaultCellDimension;
@@ -242,6 +361,53 @@ private :
 
 
 
+/**
+ * @brief Select a compile-time connectivity from a cell dimension known at
+ * run time.
+ *
+ * Dispatch calls functor(Connectivity<VDimension, k>::GetInstance()) with k
+ * equal to the given cell dimension, so that the functor may instantiate the
+ * code specialized for each connectivity, e.g. a SkeletonizeImageFilter, and
+ * choose among them at run time. The cell dimensions from VCellDimension
+ * down to 0 are instantiated.
+ */
+template<unsigned int VDimension, int VCellDimension = VDimension-1>
+struct ITK_EXPORT ConnectivityDispatcher
+  {
+  template<typename TFunctor>
+  static void Dispatch(unsigned int cellDimension, TFunctor & functor)
+    {
+    if( static_cast<int>(cellDimension) == VCellDimension )
+      {
+      functor( Connectivity<VDimension, VCellDimension>::GetInstance() );
+      }
+    else
+      {
+      ConnectivityDispatcher<VDimension, VCellDimension-1>
+        ::Dispatch( cellDimension, functor );
+      }
+    }
+
+  /** @brief Select the cell dimension of a run-time connectivity. */
+  template<typename TFunctor>
+  static void Dispatch(Connectivity<VDimension> const & connectivity, 
+                       TFunctor & functor)
+    {
+    Dispatch( connectivity.GetCellDimension(), functor );
+    }
+  };
+
+template<unsigned int VDimension>
+struct ITK_EXPORT ConnectivityDispatcher<VDimension, -1>
+  {
+  template<typename TFunctor>
+  static void Dispatch(unsigned int cellDimension, TFunctor &)
+    {
+    itkGenericExceptionMacro( << cellDimension << " is not a valid cell dimension for dimension " << VDimension << "." );
+    }
+  };
+
+
 /** creation of equivalent iterators */
 template < class IteratorType, class ConnectivityType >
 void setConnectivity( IteratorType * it, ConnectivityType * connectivity )
@@ -1,19 +1,181 @@
 #ifndef __itkConnectivity_txx
 #define __itkConnectivity_txx
 
+#include <cassert>
+
 #include "itkConnectivity.h"
 
 namespace itk
 {
 
+template<unsigned int VDimension, int VCellDimension>
+Connectivity<VDimension, VCellDimension> const &
+Connectivity<VDimension, VCellDimension>
+::GetInstance()
+{
+  static Self const instance;
+  return instance;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+Connectivity<VDimension, VCellDimension>
+::Connectivity()
+{
+  for(unsigned int i=0; i<sizeof(m_Membership)/sizeof(m_Membership[0]); ++i)
+    {
+    m_Membership[i] = 0;
+    }
+
+  unsigned int neighbor = 0;
+  for(int offset=0; offset<static_cast<int>(NeighborhoodSize); ++offset)
+    {
+    Point const p = OffsetToPoint( offset );
+
+    unsigned int numberOfZeros = 0;
+    for(unsigned int d=0; d<Dimension; ++d)
+      {
+      if( p[d] == 0 )
+        {
+        ++numberOfZeros;
+        }
+      }
+
+    if( numberOfZeros != Dimension && numberOfZeros >= CellDimension )
+      {
+      m_NeighborsPoints[neighbor] = p;
+      m_NeighborsOffsets[neighbor] = offset;
+      ++neighbor;
+      m_Membership[offset/BitsPerWord] |= 1UL << (offset%BitsPerWord);
+      }
+    }
+  assert( neighbor == NumberOfNeighbors );
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+int
+Connectivity<VDimension, VCellDimension>
+::GetNeighborhoodSize() const
+{
+  return NeighborhoodSize;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+int
+Connectivity<VDimension, VCellDimension>
+::GetNumberOfNeighbors() const
+{
+  return NumberOfNeighbors;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+typename Connectivity<VDimension, VCellDimension>::Point const *
+Connectivity<VDimension, VCellDimension>
+::GetNeighborsPoints() const
+{
+  return m_NeighborsPoints;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+typename Connectivity<VDimension, VCellDimension>::Offset const *
+Connectivity<VDimension, VCellDimension>
+::GetNeighborsOffsets() const
+{
+  return m_NeighborsOffsets;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+bool
+Connectivity<VDimension, VCellDimension>
+::IsInNeighborhood(Offset offset) const
+{
+  return ( m_Membership[offset/BitsPerWord] >> (offset%BitsPerWord) ) & 1UL;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+bool
+Connectivity<VDimension, VCellDimension>
+::IsInNeighborhood(Point const & p) const
+{
+  for(unsigned int d=0; d<Dimension; ++d)
+    {
+    if( p[d] < -1 || p[d] > 1 )
+      {
+      return false;
+      }
+    }
+  return this->IsInNeighborhood( PointToOffset( p ) );
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+bool
+Connectivity<VDimension, VCellDimension>
+::AreNeighbors(Point const & p1, Point const & p2) const
+{
+  Point diff;
+  for(unsigned int d=0; d<Dimension; ++d)
+    {
+    diff[d] = p2[d] - p1[d];
+    }
+  return this->IsInNeighborhood( diff );
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+bool
+Connectivity<VDimension, VCellDimension>
+::AreNeighbors(Offset o1, Offset o2) const
+{
+  return this->AreNeighbors( OffsetToPoint( o1 ), OffsetToPoint( o2 ) );
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+typename Connectivity<VDimension, VCellDimension>::Offset
+Connectivity<VDimension, VCellDimension>
+::PointToOffset(Point const & p)
+{
+  Offset offset = 0;
+  Offset factor = 1;
+  for(unsigned int d=0; d<Dimension; ++d)
+    {
+    offset += factor * (p[d]+1);
+    factor *= 3;
+    }
+  return offset;
+}
+
+
+template<unsigned int VDimension, int VCellDimension>
+typename Connectivity<VDimension, VCellDimension>::Point
+Connectivity<VDimension, VCellDimension>
+::OffsetToPoint(Offset offset)
+{
+  Point p;
+  for(unsigned int d=0; d<Dimension; ++d)
+    {
+    p[d] = offset % 3 - 1;
+    offset /= 3;
+    }
+  return p;
+}
+
+
 template<unsigned int VDimension>
 int
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::m_GlobalDefaultCellDimension = VDimension - 1;
 
 
 template<unsigned int VDimension>
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::Connectivity()
 {
   this->SetCellDimension( m_GlobalDefaultCellDimension );
@@ -22,7 +184,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 bool
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::AreNeighbors(IndexType const & p1, IndexType const & p2) const
 {
   OffsetType diff;
@@ -37,18 +199,23 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 bool 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::IsInNeighborhood(OffsetType const & o) const
 {
-  typename OffsetContainerType::const_iterator iterator = 
-    std::find(m_Neighbors.begin(), m_Neighbors.end(), o);
-  return (iterator != m_Neighbors.end());
+  for(unsigned int d=0; d<Dimension; ++d)
+    {
+    if( o[d] < -1 || o[d] > 1 )
+      {
+      return false;
+      }
+    }
+  return m_Membership[ OffsetToInt( o ) ];
 }
 
 
 template<unsigned int VDimension>
-const typename Connectivity<VDimension>::OffsetContainerType &
-Connectivity<VDimension>
+const typename Connectivity<VDimension, -1>::OffsetContainerType &
+Connectivity<VDimension, -1>
 ::GetNeighbors() const
 {
   return m_Neighbors;
@@ -57,7 +224,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 int
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetNeighborhoodSize()
 {
   return static_cast<int>(vcl_pow( 3.0, static_cast<double>(VDimension) ) );
@@ -66,7 +233,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 int
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetNumberOfNeighbors() const
 {
   return m_Neighbors.size();
@@ -75,7 +242,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::SetNumberOfNeighbors( int nb )
 {
   // and search a matching cell dimension. It should be quite
@@ -99,7 +266,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 int 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::ComputeNumberOfNeighbors( int cellDimension )
 {
   int numberOfNeighbors = 0;
@@ -115,7 +282,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::SetCellDimension( unsigned int dim )
 {
   // check the validity of the requested cell dimension
@@ -130,6 +297,7 @@ Connectivity<VDimension>
   m_Neighbors.reserve( ComputeNumberOfNeighbors( dim ) );
 
   int neighborhoodSize = this->GetNeighborhoodSize();
+  m_Membership.assign( neighborhoodSize, false );
   for(int i=0; i< neighborhoodSize; ++i)
     {
     OffsetType const offset = IntToOffset( i );
@@ -146,6 +314,7 @@ Connectivity<VDimension>
     if( numberOfZeros!=VDimension && numberOfZeros >= m_CellDimension)
       {
       m_Neighbors.push_back( offset );
+      m_Membership[i] = true;
       }
     }
 }
@@ -153,7 +322,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 const unsigned int &
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetCellDimension() const
 {
   return m_CellDimension;
@@ -162,7 +331,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::SetFullyConnected( bool value )
 {
   if( value )
@@ -178,7 +347,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 bool 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetFullyConnected() const
 {
   if( m_CellDimension == 0 )
@@ -191,8 +360,8 @@ Connectivity<VDimension>
 
 
 template<unsigned int VDimension>
-typename Connectivity<VDimension>::OffsetType
-Connectivity<VDimension>
+typename Connectivity<VDimension, -1>::OffsetType
+Connectivity<VDimension, -1>
 ::IntToOffset( int i )
 {
   OffsetType o;
@@ -211,14 +380,14 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 int
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::OffsetToInt( const OffsetType & o )
 {
   int i=0;
   int factor=1;
   for(unsigned int d=0; d<Dimension; ++d)
     {
-    d += factor * (o[d]+1);
+    i += factor * (o[d]+1);
     factor *= 3;
     }
   
@@ -228,7 +397,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 int
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::factorial( int n )
   {
   if( n<=1 )
@@ -241,7 +410,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::SetGlobalDefaultCellDimension( unsigned int dim )
 {
   // check the validity of the requested cell dimension
@@ -256,7 +425,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 const int &
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetGlobalDefaultCellDimension()
 {
   return m_GlobalDefaultCellDimension;
@@ -265,7 +434,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::SetGlobalDefaultFullyConnected( bool value )
 {
   if( value )
@@ -281,7 +450,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 bool 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetGlobalDefaultFullyConnected()
 {
   if( m_GlobalDefaultCellDimension == 0 )
@@ -295,7 +464,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 int
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::GetGlobalDefaultNumberOfNeighbors()
 {
   return ComputeNumberOfNeighbors( m_GlobalDefaultCellDimension );
@@ -304,7 +473,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::SetGlobalDefaultNumberOfNeighbors( int nb )
 {
   // and search a matching cell dimension. It should be quite
@@ -328,7 +497,7 @@ Connectivity<VDimension>
 
 template<unsigned int VDimension>
 void 
-Connectivity<VDimension>
+Connectivity<VDimension, -1>
 ::PrintSelf(std::ostream& os, Indent indent) const
 {
   Superclass::PrintSelf( os, indent );
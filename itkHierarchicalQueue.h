@@ -17,12 +17,126 @@
 #ifndef __itkHierarchicalQueue_h
 #define __itkHierarchicalQueue_h
 
-// #include <vector>
+#include <cassert>
 #include <list>
 #include <map>
+#include <vector>
+
+#include "itkNumericTraits.h"
 
 namespace itk
 {
+
+/** \class HierarchicalQueueOccupancy
+ *  \brief Set of the non-empty buckets of a hierarchical queue
+ *
+ * The set is stored as a hierarchy of 32 bits words: each bit of a level
+ * tells if the matching word of the level below is not null, and the last
+ * level is a single word. The first element of the set is thus found with one
+ * bit scan per level, that is at most 7 for 2^32 buckets, instead of a walk
+ * through all the empty buckets.
+ */
+class HierarchicalQueueOccupancy
+{
+
+public:
+
+  typedef unsigned int WordType;
+
+  /** resize the set to n buckets, all of them empty */
+  void Resize( const unsigned long n )
+    {
+    m_Size = n;
+    m_Levels.clear();
+    unsigned long levelSize = n;
+    do
+      {
+      levelSize = ( levelSize + 31 ) / 32;
+      m_Levels.push_back( std::vector<WordType>( levelSize, 0 ) );
+      }
+    while( levelSize > 1 );
+    }
+
+  /** return the number of buckets */
+  inline unsigned long Size() const
+    {
+    return m_Size;
+    }
+
+  /** mark the bucket i as non-empty */
+  inline void Set( unsigned long i )
+    {
+    for( unsigned int level = 0; level < m_Levels.size(); level++ )
+      {
+      WordType & word = m_Levels[level][ i / 32 ];
+      const bool wasEmpty = ( word == 0 );
+      word |= WordType(1) << ( i % 32 );
+      if( !wasEmpty )
+        {
+        return;
+        }
+      i /= 32;
+      }
+    }
+
+  /** mark the bucket i as empty */
+  inline void Reset( unsigned long i )
+    {
+    for( unsigned int level = 0; level < m_Levels.size(); level++ )
+      {
+      WordType & word = m_Levels[level][ i / 32 ];
+      word &= ~( WordType(1) << ( i % 32 ) );
+      if( word != 0 )
+        {
+        return;
+        }
+      i /= 32;
+      }
+    }
+
+  /** return the first non-empty bucket, or Size() if there is none */
+  inline unsigned long First() const
+    {
+    if( m_Levels.empty() || m_Levels.back()[0] == 0 )
+      {
+      return m_Size;
+      }
+    unsigned long i = 0;
+    for( int level = m_Levels.size() - 1; level >= 0; level-- )
+      {
+      i = i * 32 + LowestBit( m_Levels[level][i] );
+      }
+    return i;
+    }
+
+  HierarchicalQueueOccupancy()
+    {
+    m_Size = 0;
+    }
+
+private:
+
+  static inline unsigned int LowestBit( WordType w )
+    {
+    assert( w != 0 );
+#if defined(__GNUC__)
+    return __builtin_ctz( w );
+#else
+    unsigned int bit = 0;
+    while( ( w & 1 ) == 0 )
+      {
+      w >>= 1;
+      bit++;
+      }
+    return bit;
+#endif
+    }
+
+  std::vector< std::vector<WordType> > m_Levels;
+  unsigned long m_Size;
+
+};
+
 /** \class HierarchicalQueue
  *  \brief HierarchicalQueue class
  * 
@@ -157,6 +271,7 @@ public:
     assert( k  - NT::NonpositiveMin() >= 0 );
 
     m_Vector[ k  - NT::NonpositiveMin() ].push_back( v );
+    m_Occupancy.Set( this->Position( k ) );
     if( this->Empty() || m_Compare( k, m_CurrentValue ) )
       {
       m_CurrentValue = k;
@@ -184,12 +299,21 @@ public:
     valueList.pop_front();
     m_Size--;
 
-    if( valueList.empty() && !this->Empty() )
+    if( valueList.empty() )
       {
-      // update the current key to a new value
-      while( m_Vector[ m_CurrentValue - NT::NonpositiveMin() ].empty() )
+      m_Occupancy.Reset( this->Position( m_CurrentValue ) );
+      if( !this->Empty() )
         {
-        m_CurrentValue += m_Direction;
+        // update the current key to the first non-empty list
+        const long position = m_Occupancy.First();
+        if( m_Direction > 0 )
+          {
+          m_CurrentValue = static_cast<KeyType>( NT::NonpositiveMin() + position );
+          }
+        else
+          {
+          m_CurrentValue = static_cast<KeyType>( NT::max() - position );
+          }
         }
       }
 
@@ -209,6 +333,7 @@ public:
     m_Size = 0;
     // initialized to make valgrind happy
     m_CurrentValue = 0;
+    m_Occupancy.Resize( m_Vector.size() );
 
     assert( m_Vector.size() != 0 );
     }
@@ -218,7 +343,249 @@ protected:
 
 private:
 
+  /** position of a key in the occupancy set, the front key being the first */
+  inline unsigned long Position( const KeyType & k ) const
+    {
+    if( m_Direction > 0 )
+      {
+      return static_cast<long>( k ) - static_cast<long>( NT::NonpositiveMin() );
+      }
+    return static_cast<long>( NT::max() ) - static_cast<long>( k );
+    }
+
   VectorType m_Vector;
+  HierarchicalQueueOccupancy m_Occupancy;
+  unsigned long m_Size;
+  TKey m_CurrentValue;
+  TCompare m_Compare;
+  signed int m_Direction;
+
+};
+
+/** \class BucketHierarchicalQueue
+ *  \brief Hierarchical queue for 32 bits integer keys
+ *
+ * The keys are too many to allocate a list for each of them, as
+ * VectorHierarchicalQueue does, but the keys actually used, like the
+ * distances of a chamfer map, are usually in a small range. This class
+ * allocates a bucket for each key of the observed range only, and doubles the
+ * range when a key falls outside of it. Each bucket is a vector read from its
+ * head, so that Push and Pop do not allocate once the buckets have grown. The
+ * next non-empty bucket is found with a HierarchicalQueueOccupancy.
+ *
+ * The memory used is proportional to the range of the keys: keys spread over
+ * most of the 32 bits range are better handled by a map.
+ */
+template <typename TKey, typename TValue, typename TCompare >
+class BucketHierarchicalQueue
+{
+
+public:
+
+  /** Standard typedefs */
+  typedef BucketHierarchicalQueue      Self;
+
+  typedef TValue ValueType;
+  typedef TKey KeyType;
+  typedef TCompare CompareType;
+
+  // for code conciseness
+  typedef NumericTraits< TKey > NT;
+
+  /** return the current key */
+  inline const KeyType & FrontKey() const
+    {
+    assert(!this->Empty());
+    return m_CurrentValue;
+    }
+
+  /** return the current value */
+  inline const ValueType & FrontValue() const
+    {
+    assert(!this->Empty());
+    const BucketType & bucket = m_Buckets[ m_CurrentBucket ];
+    return bucket.m_Values[ bucket.m_Head ];
+    }
+
+  /** push a value in the queue */
+  inline void Push( const KeyType & k, const ValueType & v)
+    {
+    const unsigned int position = this->Position( k );
+    if( m_Buckets.empty() || position < m_Base
+        || position - m_Base >= m_Buckets.size() )
+      {
+      this->Grow( position );
+      }
+
+    const unsigned long b = position - m_Base;
+    m_Buckets[ b ].m_Values.push_back( v );
+    m_Occupancy.Set( b );
+    if( this->Empty() || b < m_CurrentBucket )
+      {
+      m_CurrentBucket = b;
+      m_CurrentValue = k;
+      }
+    m_Size++;
+    }
+
+  /** return the size of the queue */
+  inline const unsigned long & Size() const
+    {
+    return m_Size;
+    }
+
+  /** return true if the queue is empty */
+  inline const bool Empty() const
+    {
+    return m_Size == 0;
+    }
+
+  /** remove the first element of the queue */
+  inline void Pop()
+    {
+    assert(!this->Empty());
+    BucketType & bucket = m_Buckets[ m_CurrentBucket ];
+    bucket.m_Head++;
+    m_Size--;
+
+    if( bucket.m_Head == bucket.m_Values.size() )
+      {
+      // keep the memory of the bucket for the next pushes
+      bucket.m_Values.clear();
+      bucket.m_Head = 0;
+      m_Occupancy.Reset( m_CurrentBucket );
+      if( !this->Empty() )
+        {
+        m_CurrentBucket = m_Occupancy.First();
+        m_CurrentValue = this->Key( m_Base + m_CurrentBucket );
+        }
+      }
+    else if( bucket.m_Head >= 1024 && 2 * bucket.m_Head >= bucket.m_Values.size() )
+      {
+      // values are pushed in the front bucket while it is read: drop the
+      // values already read before they use more memory than the others
+      bucket.m_Values.erase( bucket.m_Values.begin(),
+                             bucket.m_Values.begin() + bucket.m_Head );
+      bucket.m_Head = 0;
+      }
+    }
+
+  BucketHierarchicalQueue()
+    {
+    m_Direction = m_Compare( NT::max(), NT::NonpositiveMin() ) ? -1 : 1;
+    m_Size = 0;
+    m_Base = 0;
+    m_CurrentBucket = 0;
+    // initialized to make valgrind happy
+    m_CurrentValue = 0;
+    }
+
+
+protected:
+
+private:
+
+  struct BucketType
+    {
+    std::vector<ValueType> m_Values;
+    typename std::vector<ValueType>::size_type m_Head;
+    BucketType() : m_Head( 0 ) {}
+    };
+
+  typedef std::vector<BucketType> BucketVectorType;
+
+  /** position of a key on the 32 bits range, the front key being the first */
+  inline unsigned int Position( const KeyType & k ) const
+    {
+    if( m_Direction > 0 )
+      {
+      return static_cast<unsigned int>( k )
+        - static_cast<unsigned int>( NT::NonpositiveMin() );
+      }
+    return static_cast<unsigned int>( NT::max() ) - static_cast<unsigned int>( k );
+    }
+
+  /** key at a position on the 32 bits range */
+  inline KeyType Key( const unsigned int position ) const
+    {
+    if( m_Direction > 0 )
+      {
+      return static_cast<KeyType>(
+        position + static_cast<unsigned int>( NT::NonpositiveMin() ) );
+      }
+    return static_cast<KeyType>( static_cast<unsigned int>( NT::max() ) - position );
+    }
+
+  /** extend the range of the buckets so that it contains position */
+  void Grow( const unsigned int position )
+    {
+    const unsigned int maxPosition = NumericTraits<unsigned int>::max();
+    const unsigned long minimumSize = 256;
+
+    if( m_Buckets.empty() )
+      {
+      m_Base = position;
+      unsigned long size = minimumSize;
+      if( size - 1 > maxPosition - m_Base )
+        {
+        size = static_cast<unsigned long>( maxPosition - m_Base ) + 1;
+        }
+      m_Buckets.resize( size );
+      m_Occupancy.Resize( size );
+      return;
+      }
+
+    // new range: the old one and the new key, or twice the old one if it is
+    // larger, extended on the side of the new key
+    const unsigned long oldSize = m_Buckets.size();
+    const unsigned long doubleSize = 2 * oldSize;
+    const unsigned int oldLast = m_Base + static_cast<unsigned int>( oldSize - 1 );
+    unsigned int first = m_Base;
+    unsigned int last = oldLast;
+    if( position < m_Base )
+      {
+      first = position;
+      if( oldLast - position < doubleSize - 1 )
+        {
+        first = ( oldLast >= doubleSize - 1 ) ?
+          oldLast - static_cast<unsigned int>( doubleSize - 1 ) : 0;
+        }
+      }
+    else
+      {
+      last = position;
+      if( position - m_Base < doubleSize - 1 )
+        {
+        last = ( maxPosition - m_Base >= doubleSize - 1 ) ?
+          m_Base + static_cast<unsigned int>( doubleSize - 1 ) : maxPosition;
+        }
+      }
+
+    const unsigned long shift = m_Base - first;
+    BucketVectorType buckets( static_cast<unsigned long>( last - first ) + 1 );
+    for( unsigned long b = 0; b < oldSize; b++ )
+      {
+      buckets[ b + shift ].m_Values.swap( m_Buckets[ b ].m_Values );
+      buckets[ b + shift ].m_Head = m_Buckets[ b ].m_Head;
+      }
+    m_Buckets.swap( buckets );
+    m_Base = first;
+
+    m_Occupancy.Resize( m_Buckets.size() );
+    for( unsigned long b = 0; b < m_Buckets.size(); b++ )
+      {
+      if( !m_Buckets[ b ].m_Values.empty() )
+        {
+        m_Occupancy.Set( b );
+        }
+      }
+    m_CurrentBucket += shift;
+    }
+
+  BucketVectorType m_Buckets;
+  HierarchicalQueueOccupancy m_Occupancy;
+  unsigned int m_Base;
+  unsigned long m_CurrentBucket;
   unsigned long m_Size;
   TKey m_CurrentValue;
   TCompare m_Compare;
@@ -256,6 +623,18 @@ class HierarchicalQueue<bool, TValue, TCompare>
 {
 };
 
+template <typename TValue, typename TCompare >
+class HierarchicalQueue<unsigned int, TValue, TCompare>
+: public BucketHierarchicalQueue<unsigned int, TValue, TCompare>
+{
+};
+
+template <typename TValue, typename TCompare >
+class HierarchicalQueue<signed int, TValue, TCompare>
+: public BucketHierarchicalQueue<signed int, TValue, TCompare>
+{
+};
+
 
 } // end namespace itk
 
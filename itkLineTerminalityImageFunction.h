@@ -19,7 +19,7 @@ public :
      */
     //@{
     typedef LineTerminalityImageFunction Self;
-    typedef itk::ImageFunction<TImage, bool > Superclass;
+    typedef itk::BinaryImageFunction<TImage, bool > Superclass;
     typedef itk::SmartPointer<Self> Pointer;
     typedef itk::SmartPointer<Self const> ConstPointer;
 
@@ -29,6 +29,9 @@ public :
     typedef typename Superclass::PointType PointType;
     typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
     typedef typename Superclass::IndexType IndexType;
+    typedef typename Superclass::OffsetValueType OffsetValueType;
+    typedef typename Superclass::InputPixelType InputPixelType;
+    typedef typename Superclass::ConfigurationType ConfigurationType;
     //@}
     
     /**
@@ -48,11 +51,64 @@ public :
     bool EvaluateAtIndex(IndexType const & index) const;
     
     bool EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const;
+    
+    /** 
+     * @brief Evaluate the terminality at an offset of the buffer. This 
+     * function is not virtual, so that it may be inlined when the type of 
+     * the functor is known, e.g. by SkeletonizeImageFilter.
+     */
+    bool EvaluateAtOffset(OffsetValueType offset) const;
+    
+    /**
+     * @brief Evaluate the terminality at an offset of the buffer, with the 
+     * given foreground value, e.g. the label of the point in a label map. 
+     * Only up to the dimension 3.
+     */
+    bool EvaluateAtOffset(OffsetValueType offset, 
+                          InputPixelType const & foregroundValue) const;
+    
+    /**
+     * @brief Evaluate the terminality on the configuration gathered around 
+     * a point, counting the neighbors in it. Only up to the dimension 3.
+     */
+    bool EvaluateConfiguration(ConfigurationType configuration) const;
+    
+    /** 
+     * @brief Batch evaluation, counting the neighbors in the configurations 
+     * of the points gathered at once.
+     */
+    void EvaluateAtOffsets(OffsetValueType const * offsets, 
+                           unsigned long count, bool * results) const;
+    
+    /** @brief Batch evaluation at indices, through EvaluateAtOffsets. */
+    void EvaluateAtIndices(IndexType const * indices, unsigned long count,
+                           bool * results) const
+      {
+      this->EvaluateAtIndicesByOffsets(indices, count, results);
+      }
     //@}
 
   private :
     LineTerminalityImageFunction(Self const &); // not implemented
     Self & operator=(Self const &); // not implemented
+
+    /** 
+     * @brief Tag selecting the evaluation on the packed configuration, up to 
+     * the dimension 3.
+     */
+    template<bool VUseConfiguration>
+    struct UseConfiguration {};
+
+    bool EvaluateAtIndex(IndexType const & index, UseConfiguration<true>) const;
+    bool EvaluateAtIndex(IndexType const & index, UseConfiguration<false>) const;
+
+    bool EvaluateAtOffset(OffsetValueType offset, UseConfiguration<true>) const;
+    bool EvaluateAtOffset(OffsetValueType offset, UseConfiguration<false>) const;
+
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           bool * results, UseConfiguration<true>) const;
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           bool * results, UseConfiguration<false>) const;
   };
 
 }
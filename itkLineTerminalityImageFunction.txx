@@ -1,6 +1,7 @@
 #ifndef itkLineTerminalityImageFunction_txx
 #define itkLineTerminalityImageFunction_txx
 
+#include <algorithm>
 
 
 #include "itkLineTerminalityImageFunction.h"
@@ -28,7 +29,7 @@ LineTerminalityImageFunction<TImage, TForegroundConnectivity,
 ::Evaluate(PointType const & point) const
   {
   typename TImage::IndexType index;
-  ConvertPointToNearestIndex(point, index);
+  this->ConvertPointToNearestIndex(point, index);
   return EvaluateAtIndex(index);
   }
 
@@ -41,6 +42,40 @@ LineTerminalityImageFunction<TImage, TForegroundConnectivity,
 
                              TBackgroundConnectivity>
 ::EvaluateAtIndex(IndexType const & index) const
+  {
+  return this->EvaluateAtIndex(index, 
+    UseConfiguration<(TForegroundConnectivity::Dimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseConfiguration<true>) const
+  {
+  typedef typename Superclass::NeighborhoodConfigurationType 
+    NeighborhoodConfigurationType;
+  static typename NeighborhoodConfigurationType::ConfigurationType const 
+    neighbors = NeighborhoodConfigurationType::template 
+      GetNeighborsMask<TForegroundConnectivity>();
+  
+  typename NeighborhoodConfigurationType::ConfigurationType const 
+    configuration = this->m_NeighborhoodConfiguration.GatherAtIndex(index, 
+      this->m_ForegroundValue);
+  
+  return (NeighborhoodConfigurationType::CountPoints(configuration & neighbors)
+          == 1);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseConfiguration<false>) const
   {
   TForegroundConnectivity const & fgc = TForegroundConnectivity::GetInstance();
   int nbNeighbors = 0;
@@ -62,6 +97,120 @@ LineTerminalityImageFunction<TImage, TForegroundConnectivity,
   }
 
 
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset) const
+  {
+  return this->EvaluateAtOffset(offset, 
+    UseConfiguration<(TForegroundConnectivity::Dimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, UseConfiguration<true>) const
+  {
+  return this->EvaluateAtOffset(offset, this->m_ForegroundValue);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, 
+                   InputPixelType const & foregroundValue) const
+  {
+  return this->EvaluateConfiguration(
+    this->m_NeighborhoodConfiguration.Gather(offset, foregroundValue));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateConfiguration(ConfigurationType configuration) const
+  {
+  typedef typename Superclass::NeighborhoodConfigurationType 
+    NeighborhoodConfigurationType;
+  static ConfigurationType const neighbors = 
+    NeighborhoodConfigurationType::template 
+      GetNeighborsMask<TForegroundConnectivity>();
+  
+  return (NeighborhoodConfigurationType::CountPoints(neighbors & 
+                                                     configuration) == 1);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, UseConfiguration<false>) const
+  {
+  return this->EvaluateAtIndex(this->GetInputImage()->ComputeIndex(offset), 
+                               UseConfiguration<false>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+void
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count, 
+                    bool * results) const
+  {
+  this->EvaluateAtOffsets(offsets, count, results, 
+    UseConfiguration<(TForegroundConnectivity::Dimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+void
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count, 
+                    bool * results, UseConfiguration<true>) const
+  {
+  ConfigurationType configurations[Superclass::BatchSize];
+  for(unsigned long batch = 0; batch < count; batch += Superclass::BatchSize)
+    {
+    unsigned long const batchCount = 
+      std::min<unsigned long>(Superclass::BatchSize, count - batch);
+    this->m_NeighborhoodConfiguration.Gather(offsets + batch, batchCount, 
+      this->m_ForegroundValue, configurations);
+    for(unsigned long i = 0; i < batchCount; ++i)
+      {
+      results[batch+i] = this->EvaluateConfiguration(configurations[i]);
+      }
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+void
+LineTerminalityImageFunction<TImage, TForegroundConnectivity, 
+                             TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count, 
+                    bool * results, UseConfiguration<false>) const
+  {
+  this->Superclass::EvaluateAtOffsets(offsets, count, results);
+  }
+
+
 template<typename TImage, typename TForegroundConnectivity, 
 
          typename TBackgroundConnectivity >
@@ -72,7 +221,7 @@ LineTerminalityImageFunction<TImage, TForegroundConnectivity,
 ::EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const
 {
   typename TImage::IndexType index;
-  ConvertContinuousIndexToNearestIndex(contIndex, index);
+  this->ConvertContinuousIndexToNearestIndex(contIndex, index);
   return EvaluateAtIndex(index);
 }
 
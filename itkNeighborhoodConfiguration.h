@@ -0,0 +1,100 @@
+#ifndef itkNeighborhoodConfiguration_h
+#define itkNeighborhoodConfiguration_h
+
+#include "itkUnitCubeNeighbors.h"
+
+namespace itk
+{
+
+/**
+ * @brief Gather the unit cube around a point of an image in a packed integer.
+ *
+ * Bit i of the configuration is set iff the i-th point of the unit cube has a
+ * given value, the center being skipped (the points after the center are
+ * thus shifted by one). The points are numbered as in
+ * Connectivity::OffsetToPoint, i.e. the first coordinate varies fastest. This
+ * is the layout used by SimplePointLookupTable.
+ *
+ * The offsets of the points in the buffer of the image are computed once by
+ * SetImage, so gathering a configuration costs one read per point. The
+ * image must not be reallocated afterwards, and the point must not be on the
+ * border of its buffer.
+ *
+ * Only the dimensions up to 3 are supported, since the configuration must fit
+ * in an unsigned long.
+ */
+template<typename TImage>
+class ITK_EXPORT NeighborhoodConfiguration
+  {
+  public :
+    typedef NeighborhoodConfiguration Self;
+
+    /** @brief Type of a packed neighborhood configuration. */
+    typedef unsigned long ConfigurationType;
+
+    typedef typename TImage::PixelType PixelType;
+    typedef typename TImage::IndexType IndexType;
+    typedef typename TImage::OffsetValueType OffsetValueType;
+
+    itkStaticConstMacro(Dimension, unsigned int, TImage::ImageDimension);
+
+    /** @brief Number of points in the unit cube, center included. */
+    itkStaticConstMacro(NeighborhoodSize, unsigned int,
+                        UnitCubeSize<TImage::ImageDimension>::Value);
+
+    /** @brief Number of bits in a configuration. */
+    itkStaticConstMacro(NumberOfBits, unsigned int, NeighborhoodSize-1);
+
+    NeighborhoodConfiguration();
+
+    /** @brief Set the image and compute the offsets of the unit cube. */
+    void SetImage(TImage const * image);
+
+    /**
+     * @name Gathering functions
+     *
+     * These functions return the configuration of the points of the unit
+     * cube equal to value, around a point given by its offset in the buffer
+     * or by its index.
+     */
+    //@{
+    ConfigurationType Gather(OffsetValueType offset,
+                             PixelType const & value) const;
+
+    ConfigurationType GatherAtIndex(IndexType const & index,
+                                    PixelType const & value) const;
+
+    /**
+     * @brief Gather the configurations of count points given by their 
+     * offsets. The points of the unit cube are read one at a time for all
+     * the points, so that the inner loop has no dependency.
+     */
+    void Gather(OffsetValueType const * offsets, unsigned long count,
+                PixelType const & value, 
+                ConfigurationType * configurations) const;
+    //@}
+
+    /** @brief Return the bit of the i-th point of the unit cube. */
+    static ConfigurationType GetBit(unsigned int point);
+
+    /** @brief Return the configuration made of the neighbors of the center. */
+    template<typename TConnectivity>
+    static ConfigurationType GetNeighborsMask();
+
+    /** @brief Number of points in a configuration. */
+    static unsigned int CountPoints(ConfigurationType configuration);
+
+  private :
+    TImage const * m_Image;
+    PixelType const * m_Buffer;
+    OffsetValueType m_Offsets[NumberOfBits];
+  };
+
+}
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkNeighborhoodConfiguration.txx"
+#endif
+
+#endif // itkNeighborhoodConfiguration_h
@@ -0,0 +1,160 @@
+#ifndef itkNeighborhoodConfiguration_txx
+#define itkNeighborhoodConfiguration_txx
+
+#include <algorithm>
+
+#include "itkNeighborhoodConfiguration.h"
+
+namespace itk
+{
+
+template<typename TImage>
+NeighborhoodConfiguration<TImage>
+::NeighborhoodConfiguration()
+: m_Image(0), m_Buffer(0)
+  {
+  }
+
+
+template<typename TImage>
+void
+NeighborhoodConfiguration<TImage>
+::SetImage(TImage const * image)
+  {
+  m_Image = image;
+  m_Buffer = (image != 0) ? image->GetBufferPointer() : 0;
+  if(image == 0)
+    {
+    return;
+    }
+
+  OffsetValueType const * const offsetTable = image->GetOffsetTable();
+  unsigned int bit = 0;
+  for(unsigned int i=0; i<NeighborhoodSize; ++i)
+    {
+    if(i == NeighborhoodSize/2)
+      {
+      continue;
+      }
+
+    int remainder = i;
+    OffsetValueType offset = 0;
+    for(unsigned int j=0; j<Dimension; ++j)
+      {
+      offset += (remainder % 3 - 1) * offsetTable[j];
+      remainder /= 3;
+      }
+    m_Offsets[bit] = offset;
+    ++bit;
+    }
+  }
+
+
+template<typename TImage>
+typename NeighborhoodConfiguration<TImage>::ConfigurationType
+NeighborhoodConfiguration<TImage>
+::Gather(OffsetValueType offset, PixelType const & value) const
+  {
+  PixelType const * const center = m_Buffer + offset;
+  ConfigurationType configuration = 0;
+  for(unsigned int bit=0; bit<NumberOfBits; ++bit)
+    {
+    if(center[m_Offsets[bit]] == value)
+      {
+      configuration |= ConfigurationType(1) << bit;
+      }
+    }
+  return configuration;
+  }
+
+
+template<typename TImage>
+typename NeighborhoodConfiguration<TImage>::ConfigurationType
+NeighborhoodConfiguration<TImage>
+::GatherAtIndex(IndexType const & index, PixelType const & value) const
+  {
+  return this->Gather(m_Image->ComputeOffset(index), value);
+  }
+
+
+template<typename TImage>
+void
+NeighborhoodConfiguration<TImage>
+::Gather(OffsetValueType const * offsets, unsigned long count,
+         PixelType const & value, ConfigurationType * configurations) const
+  {
+  PixelType const * const buffer = m_Buffer;
+  PixelType const foreground = value;
+  std::fill(configurations, configurations+count, ConfigurationType(0));
+  for(unsigned int bit=0; bit<NumberOfBits; ++bit)
+    {
+    PixelType const * const neighbors = buffer + m_Offsets[bit];
+    ConfigurationType const mask = ConfigurationType(1) << bit;
+    for(unsigned long i=0; i<count; ++i)
+      {
+      configurations[i] |= (neighbors[offsets[i]] == foreground) ? mask : 0;
+      }
+    }
+  }
+
+
+template<typename TImage>
+typename NeighborhoodConfiguration<TImage>::ConfigurationType
+NeighborhoodConfiguration<TImage>
+::GetBit(unsigned int point)
+  {
+  if(point == NeighborhoodSize/2)
+    {
+    return 0;
+    }
+  else if(point < NeighborhoodSize/2)
+    {
+    return ConfigurationType(1) << point;
+    }
+  else
+    {
+    return ConfigurationType(1) << (point-1);
+    }
+  }
+
+
+template<typename TImage>
+template<typename TConnectivity>
+typename NeighborhoodConfiguration<TImage>::ConfigurationType
+NeighborhoodConfiguration<TImage>
+::GetNeighborsMask()
+  {
+  TConnectivity const & connectivity = TConnectivity::GetInstance();
+  ConfigurationType mask = 0;
+  for(unsigned int i=0; i<NeighborhoodSize; ++i)
+    {
+    if(connectivity.IsInNeighborhood(i))
+      {
+      mask |= GetBit(i);
+      }
+    }
+  return mask;
+  }
+
+
+template<typename TImage>
+unsigned int
+NeighborhoodConfiguration<TImage>
+::CountPoints(ConfigurationType configuration)
+  {
+#if defined(__GNUC__)
+  return __builtin_popcountl(configuration);
+#else
+  unsigned int count = 0;
+  while(configuration != 0)
+    {
+    configuration &= configuration - 1;
+    ++count;
+    }
+  return count;
+#endif
+  }
+
+}
+
+#endif // itkNeighborhoodConfiguration_txx
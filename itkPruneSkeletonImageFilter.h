@@ -0,0 +1,211 @@
+#ifndef itkPruneSkeletonImageFilter_h
+#define itkPruneSkeletonImageFilter_h
+
+#include <functional>
+#include <vector>
+
+#include <itkImage.h>
+#include "itkHierarchicalQueue.h"
+#include "itkSimplicityByTopologicalNumbersImageFunction.h"
+#include <itkInPlaceImageFilter.h>
+
+namespace itk
+{
+
+/**
+ * @brief Remove the short branches of a skeleton, e.g. the spurs left by
+ * SkeletonizeImageFilter.
+ *
+ * @param TForegroundConnectivity the connectivity of the skeleton
+ * @param TOrderingImage the type of the ordering image
+ * @param TSimplicityPolicy the simplicity criterion of the junctions
+ *
+ * A branch is the chain of points from an end point, i.e. a point with one
+ * neighbor in the skeleton, to the first point with at least 3 neighbors,
+ * its junction. Its length is its number of points, the junction excluded.
+ * The branches are processed by increasing length through a
+ * HierarchicalQueue, and a branch is removed, its junction being kept, iff
+ * its length is less than MinimumBranchLength, or, when an ordering image is
+ * set, less than DistanceRatio times the ordering value at its junction
+ * divided by UnitWeight : with a distance map as ordering, a spur that is
+ * short compared to the radius of the object at its junction is not
+ * significant. The length being a number of points, UnitWeight is the
+ * ordering value of a step along an axis, e.g. the first weight of a chamfer
+ * distance.
+ *
+ * The junction of a removed branch is removed too if it became a simple
+ * point with at least 2 neighbors : with the 26-connectivity, a branch
+ * leaving a line diagonally leaves such a corner on the line. The junctions
+ * on the border of the buffer, where the unit cube is not in the image, are
+ * kept.
+ *
+ * The removal of a branch may change the junction into a point of a chain :
+ * the branches through the former junction are longer than queued, and are
+ * queued again with their new length when they come out of the queue. A
+ * curve without junction is never removed. The end points are found with a
+ * single scan of the image, then the branches are traced only up to the
+ * largest length that may be pruned, so that the cost of the pruning grows
+ * with the number of points of the short branches.
+ *
+ * @pre The ordering image must have the same buffered region as the output.
+ */
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage =
+           Image<unsigned int, TImage::ImageDimension>,
+         typename TSimplicityPolicy =
+           SimplicityByTopologicalNumbersImageFunction<
+             TImage, TForegroundConnectivity> >
+class ITK_EXPORT PruneSkeletonImageFilter : public InPlaceImageFilter<TImage>
+  {
+  public :
+    /**
+     * @name Standard ITK declarations
+     */
+    //@{
+    typedef PruneSkeletonImageFilter Self;
+    typedef InPlaceImageFilter<TImage> Superclass;
+    typedef SmartPointer<Self> Pointer;
+    typedef SmartPointer<Self const> ConstPointer;
+
+    itkNewMacro(Self);
+    itkTypeMacro(PruneSkeletonImageFilter, InPlaceImageFilter);
+    //@}
+
+    /**
+     * @name Standard filter typedefs.
+     */
+    //@{
+    typedef TImage InputImageType;
+    typedef TImage OutputImageType;
+    //@}
+
+    typedef TOrderingImage OrderingImageType;
+    typedef typename OrderingImageType::PixelType OrderingVoxelType;
+
+    typedef typename InputImageType::PixelType InputPixelType;
+    typedef typename InputImageType::IndexType IndexType;
+    typedef typename InputImageType::OffsetType OffsetType;
+    typedef typename InputImageType::OffsetValueType OffsetValueType;
+
+    /** @brief Connectivity used in the skeleton. */
+    typedef TForegroundConnectivity ForegroundConnectivity;
+
+    typedef TSimplicityPolicy SimplicityPolicyType;
+
+    /** Set/Get the foreground value. Defaults to max */
+    itkSetMacro(ForegroundValue, InputPixelType);
+    itkGetMacro(ForegroundValue, InputPixelType);
+
+    /** Set/Get the background value. Defaults to zero */
+    itkSetMacro(BackgroundValue, InputPixelType);
+    itkGetMacro(BackgroundValue, InputPixelType);
+
+    /**
+     * @brief The branches with fewer points are removed. Defaults to 5.
+     */
+    itkSetMacro(MinimumBranchLength, unsigned int);
+    itkGetConstMacro(MinimumBranchLength, unsigned int);
+
+    /**
+     * @brief Ratio of the ordering value at the junction of a branch below
+     * which its length is not significant, used with the ordering image.
+     * Defaults to 1.
+     */
+    itkSetMacro(DistanceRatio, double);
+    itkGetConstMacro(DistanceRatio, double);
+
+    /**
+     * @brief Ordering value of a step along an axis, by which the ordering
+     * values are divided to be compared with the lengths. Defaults to 1.
+     */
+    itkSetMacro(UnitWeight, double);
+    itkGetConstMacro(UnitWeight, double);
+
+    /**
+     * @name Accessors for the optional ordering image.
+     */
+    //@{
+    void SetOrderingImage(OrderingImageType * input);
+
+    OrderingImageType * GetOrderingImage();
+    //@}
+
+    /**
+     * @name Number of branches and points removed by the last update.
+     */
+    //@{
+    itkGetConstMacro(NumberOfPrunedBranches, unsigned long);
+    itkGetConstMacro(NumberOfPrunedPoints, unsigned long);
+    //@}
+
+  protected :
+    PruneSkeletonImageFilter();
+
+    void PrintSelf(std::ostream& os, Indent indent) const;
+    void GenerateInputRequestedRegion();
+    void GenerateData();
+
+  private :
+    PruneSkeletonImageFilter(Self const &); // not implemented
+    Self & operator=(Self const &); // not implemented
+
+    /** @brief The branches are queued by their end point. */
+    typedef HierarchicalQueue<unsigned int, OffsetValueType,
+                              std::less<unsigned int> > QueueType;
+
+    /** @brief Test if a point is on the border of the buffer. */
+    bool IsOnBorder(IndexType const & index) const;
+
+    /**
+     * @brief Write the offsets of the neighbors of a point of the skeleton,
+     * return their number.
+     */
+    unsigned int GetNeighbors(OffsetValueType offset,
+                              OffsetValueType * neighbors) const;
+
+    /**
+     * @brief Trace the branch from an end point, return false if the point
+     * is not an end point anymore, if the branch is longer than
+     * maximumLength, or if it ends at another end point instead of a
+     * junction.
+     */
+    bool TraceBranch(OffsetValueType endPoint, unsigned int maximumLength,
+                     std::vector<OffsetValueType> & branch,
+                     OffsetValueType & junction) const;
+
+    /** @brief Test if a branch is short enough to be removed. */
+    bool IsPrunable(unsigned int length, OffsetValueType junction) const;
+
+    typename SimplicityPolicyType::Pointer m_SimplicityPolicy;
+
+    InputPixelType m_ForegroundValue;
+    InputPixelType m_BackgroundValue;
+    unsigned int m_MinimumBranchLength;
+    double m_DistanceRatio;
+    double m_UnitWeight;
+
+    unsigned long m_NumberOfPrunedBranches;
+    unsigned long m_NumberOfPrunedPoints;
+
+    /**
+     * @name State of the update
+     */
+    //@{
+    OutputImageType * m_Image;
+    InputPixelType * m_Buffer;
+    OrderingVoxelType const * m_Ordering;
+    std::vector<OffsetType> m_Neighbors;
+    /** Offsets of the neighbors in the output buffer. */
+    std::vector<OffsetValueType> m_NeighborOffsets;
+    //@}
+  };
+
+}
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkPruneSkeletonImageFilter.txx"
+
+#endif
+
+#endif // itkPruneSkeletonImageFilter_h
@@ -0,0 +1,383 @@
+#ifndef itkPruneSkeletonImageFilter_txx
+#define itkPruneSkeletonImageFilter_txx
+
+#include <algorithm>
+#include <cmath>
+
+#include <itkNumericTraits.h>
+#include <itkProgressReporter.h>
+
+#include "itkPruneSkeletonImageFilter.h"
+
+namespace itk
+{
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::PruneSkeletonImageFilter()
+  {
+  // The ordering image is optional
+  this->SetNumberOfRequiredInputs(1);
+  m_ForegroundValue = NumericTraits<InputPixelType>::max();
+  m_BackgroundValue = NumericTraits<InputPixelType>::Zero;
+  m_MinimumBranchLength = 5;
+  m_DistanceRatio = 1;
+  m_UnitWeight = 1;
+  m_NumberOfPrunedBranches = 0;
+  m_NumberOfPrunedPoints = 0;
+  m_Image = 0;
+  m_Buffer = 0;
+  m_Ordering = 0;
+  m_SimplicityPolicy = SimplicityPolicyType::New();
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+void
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::SetOrderingImage(OrderingImageType * input)
+  {
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(1, const_cast<OrderingImageType *>(input));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+typename PruneSkeletonImageFilter<TImage, TForegroundConnectivity,
+                                  TOrderingImage, TSimplicityPolicy>
+  ::OrderingImageType *
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::GetOrderingImage()
+  {
+  return static_cast<OrderingImageType *>(
+    const_cast<DataObject *>(this->ProcessObject::GetInput(1)));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+void
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::PrintSelf(std::ostream& os, Indent indent) const
+  {
+  Superclass::PrintSelf(os, indent);
+  os << indent
+     << "Cell dimension used for foreground connectivity: "
+     << ForegroundConnectivity::CellDimension << std::endl;
+  os << indent << "ForegroundValue: "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(
+          m_ForegroundValue)
+     << std::endl;
+  os << indent << "BackgroundValue: "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(
+          m_BackgroundValue)
+     << std::endl;
+  os << indent << "MinimumBranchLength: " << m_MinimumBranchLength
+     << std::endl;
+  os << indent << "DistanceRatio: " << m_DistanceRatio << std::endl;
+  os << indent << "UnitWeight: " << m_UnitWeight << std::endl;
+  os << indent << "NumberOfPrunedBranches: " << m_NumberOfPrunedBranches
+     << std::endl;
+  os << indent << "NumberOfPrunedPoints: " << m_NumberOfPrunedPoints
+     << std::endl;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+void
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::GenerateInputRequestedRegion()
+  {
+  Superclass::GenerateInputRequestedRegion();
+
+  // The branches may cross the whole image
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if(input)
+    {
+    input->SetRequestedRegion(input->GetLargestPossibleRegion());
+    }
+  OrderingImageType * ordering = this->GetOrderingImage();
+  if(ordering)
+    {
+    ordering->SetRequestedRegion(ordering->GetLargestPossibleRegion());
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+void
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::GenerateData()
+  {
+  this->AllocateOutputs();
+
+  m_Image = this->GetOutput(0);
+  m_Buffer = m_Image->GetBufferPointer();
+  typename OutputImageType::RegionType const & region =
+    m_Image->GetBufferedRegion();
+
+  OrderingImageType * const orderingImage = this->GetOrderingImage();
+  m_Ordering = 0;
+  if(orderingImage)
+    {
+    if(orderingImage->GetBufferedRegion() != region)
+      {
+      itkExceptionMacro(<< "Ordering image buffered region "
+                        << orderingImage->GetBufferedRegion()
+                        << " differs from output buffered region "
+                        << region);
+      }
+    if(m_UnitWeight <= 0)
+      {
+      itkExceptionMacro(<< "Unit weight " << m_UnitWeight
+                        << " is not positive");
+      }
+    m_Ordering = orderingImage->GetBufferPointer();
+    }
+
+  ForegroundConnectivity const & connectivity =
+    ForegroundConnectivity::GetInstance();
+  m_Neighbors.resize(connectivity.GetNumberOfNeighbors());
+  m_NeighborOffsets.resize(m_Neighbors.size());
+  for(unsigned int i = 0; i < m_Neighbors.size(); ++i)
+    {
+    for(unsigned int j = 0; j < ForegroundConnectivity::Dimension; ++j)
+      {
+      m_Neighbors[i][j] = connectivity.GetNeighborsPoints()[i][j];
+      }
+    m_NeighborOffsets[i] =
+      m_Image->ComputeOffset(region.GetIndex() + m_Neighbors[i]);
+    }
+
+  m_SimplicityPolicy->SetInputImage(m_Image);
+  m_SimplicityPolicy->SetForegroundValue(m_ForegroundValue);
+
+  m_NumberOfPrunedBranches = 0;
+  m_NumberOfPrunedPoints = 0;
+
+  ProgressReporter progress(this, 0, region.GetNumberOfPixels());
+
+  // List the end points, and bound the length of the branches that may be
+  // pruned.
+  std::vector<OffsetValueType> endPoints;
+  std::vector<OffsetValueType> neighbors(m_Neighbors.size());
+  unsigned long numberOfPoints = 0;
+  OrderingVoxelType maximumOrdering = NumericTraits<OrderingVoxelType>::Zero;
+  OffsetValueType const size = region.GetNumberOfPixels();
+  for(OffsetValueType offset = 0; offset < size; ++offset)
+    {
+    progress.CompletedPixel();
+    if(m_Buffer[offset] != m_ForegroundValue)
+      {
+      continue;
+      }
+    ++numberOfPoints;
+    if(m_Ordering)
+      {
+      maximumOrdering = std::max(maximumOrdering, m_Ordering[offset]);
+      }
+    if(this->GetNeighbors(offset, &neighbors[0]) == 1)
+      {
+      endPoints.push_back(offset);
+      }
+    }
+
+  double bound = m_MinimumBranchLength;
+  if(m_Ordering)
+    {
+    bound = std::max(bound,
+                     m_DistanceRatio * maximumOrdering / m_UnitWeight);
+    }
+  bound = std::min(bound, static_cast<double>(numberOfPoints));
+  unsigned int const maximumLength = (bound < 1) ? 0 :
+    static_cast<unsigned int>(std::ceil(bound)) - 1;
+
+  // Shortest branches first. A branch that grew since it was queued, its
+  // junction having been changed into a point of a chain, is queued again.
+  QueueType q;
+  std::vector<OffsetValueType> branch;
+  OffsetValueType junction = 0;
+  for(unsigned long i = 0; i < endPoints.size(); ++i)
+    {
+    if(this->TraceBranch(endPoints[i], maximumLength, branch, junction))
+      {
+      q.Push(static_cast<unsigned int>(branch.size()), endPoints[i]);
+      }
+    }
+
+  while(!q.Empty())
+    {
+    unsigned int const length = q.FrontKey();
+    OffsetValueType const endPoint = q.FrontValue();
+    q.Pop();
+
+    if(!this->TraceBranch(endPoint, maximumLength, branch, junction))
+      {
+      continue;
+      }
+    if(branch.size() != length)
+      {
+      q.Push(static_cast<unsigned int>(branch.size()), endPoint);
+      continue;
+      }
+    if(!this->IsPrunable(length, junction))
+      {
+      continue;
+      }
+
+    for(unsigned int i = 0; i < branch.size(); ++i)
+      {
+      m_Buffer[branch[i]] = m_BackgroundValue;
+      }
+    ++m_NumberOfPrunedBranches;
+    m_NumberOfPrunedPoints += length;
+
+    // Remove the corner left on the junction. The simplicity policy reads
+    // the whole unit cube, so the points on the border of the buffer are
+    // kept.
+    if(!this->IsOnBorder(m_Image->ComputeIndex(junction)) &&
+       this->GetNeighbors(junction, &neighbors[0]) >= 2 &&
+       m_SimplicityPolicy->EvaluateAtOffset(junction))
+      {
+      m_Buffer[junction] = m_BackgroundValue;
+      ++m_NumberOfPrunedPoints;
+      }
+    }
+
+  m_Image = 0;
+  m_Buffer = 0;
+  m_Ordering = 0;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+unsigned int
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::GetNeighbors(OffsetValueType offset, OffsetValueType * neighbors) const
+  {
+  // Only the points on the border of the buffer check that their neighbors
+  // are inside.
+  typename OutputImageType::RegionType const & region =
+    m_Image->GetBufferedRegion();
+  IndexType const index = m_Image->ComputeIndex(offset);
+  bool const onBorder = this->IsOnBorder(index);
+
+  unsigned int count = 0;
+  for(unsigned int i = 0; i < m_NeighborOffsets.size(); ++i)
+    {
+    if(onBorder && !region.IsInside(index + m_Neighbors[i]))
+      {
+      continue;
+      }
+    OffsetValueType const neighbor = offset + m_NeighborOffsets[i];
+    if(m_Buffer[neighbor] == m_ForegroundValue)
+      {
+      neighbors[count] = neighbor;
+      ++count;
+      }
+    }
+  return count;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+bool
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::IsOnBorder(IndexType const & index) const
+  {
+  typename OutputImageType::RegionType const & region =
+    m_Image->GetBufferedRegion();
+  for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+    {
+    long const first = region.GetIndex()[j];
+    long const last = first + static_cast<long>(region.GetSize()[j]) - 1;
+    if(index[j] == first || index[j] == last)
+      {
+      return true;
+      }
+    }
+  return false;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+bool
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::TraceBranch(OffsetValueType endPoint, unsigned int maximumLength,
+              std::vector<OffsetValueType> & branch,
+              OffsetValueType & junction) const
+  {
+  branch.clear();
+  if(m_Buffer[endPoint] != m_ForegroundValue)
+    {
+    return false;
+    }
+
+  std::vector<OffsetValueType> neighbors(m_NeighborOffsets.size());
+  OffsetValueType previous = endPoint;
+  OffsetValueType current = endPoint;
+  unsigned int count = this->GetNeighbors(current, &neighbors[0]);
+  if(count != 1)
+    {
+    return false;
+    }
+  for(;;)
+    {
+    if(branch.size() == maximumLength)
+      {
+      return false;
+      }
+    branch.push_back(current);
+    OffsetValueType const next =
+      (neighbors[0] == previous) ? neighbors[1] : neighbors[0];
+    previous = current;
+    current = next;
+    count = this->GetNeighbors(current, &neighbors[0]);
+    if(count != 2)
+      {
+      break;
+      }
+    }
+
+  // The branch stops at a junction, or at another end point
+  if(count < 3)
+    {
+    return false;
+    }
+  junction = current;
+  return true;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TOrderingImage, typename TSimplicityPolicy>
+bool
+PruneSkeletonImageFilter<TImage, TForegroundConnectivity, TOrderingImage,
+                         TSimplicityPolicy>
+::IsPrunable(unsigned int length, OffsetValueType junction) const
+  {
+  return length < m_MinimumBranchLength ||
+         (m_Ordering != 0 &&
+          length * m_UnitWeight < m_DistanceRatio * m_Ordering[junction]);
+  }
+
+}
+
+#endif // itkPruneSkeletonImageFilter_txx
@@ -0,0 +1,98 @@
+#ifndef itkRunIndexedBitmap_h
+#define itkRunIndexedBitmap_h
+
+#include <vector>
+
+#include <itkMacro.h>
+
+namespace itk
+{
+
+/**
+ * @brief Flags of the points of a set of runs in the buffer of an image.
+ *
+ * The runs are segments of the lines of the buffer along the first axis,
+ * given by their offsets in the buffer. One bit is stored per point of the
+ * runs, and the runs of each line are found through a table with one entry
+ * per line : the memory grows with the number of points in the runs and the
+ * number of lines, not with the number of points of the image. The points
+ * outside of the runs are reported as flagged and cannot be changed.
+ *
+ * The runs must be added line by line in increasing order of offset, then
+ * Finalize must be called before the flags are accessed.
+ */
+template<typename TImage>
+class ITK_EXPORT RunIndexedBitmap
+  {
+  public :
+    typedef RunIndexedBitmap Self;
+
+    typedef typename TImage::SizeType SizeType;
+    typedef typename TImage::OffsetValueType OffsetValueType;
+
+    RunIndexedBitmap();
+
+    /** @brief Remove all runs, for a buffer of the given size. */
+    void Initialize(SizeType const & size);
+
+    /** @brief Add the run [begin, end), with all its points flagged. */
+    void AddRun(OffsetValueType begin, OffsetValueType end);
+
+    /** @brief Complete the table of the lines after the last run. */
+    void Finalize();
+
+    /**
+     * @name Access to the flags
+     */
+    //@{
+    bool IsSet(OffsetValueType offset) const;
+    void Set(OffsetValueType offset);
+    void Reset(OffsetValueType offset);
+    //@}
+
+    unsigned long GetNumberOfRuns() const;
+    unsigned long GetNumberOfPoints() const;
+
+  private :
+    struct Run
+      {
+      OffsetValueType Begin;
+      OffsetValueType End;
+      /** @brief Bit of the first point of the run. */
+      unsigned long Bit;
+      };
+
+    /** @brief Order of an offset and the beginning of a run. */
+    struct RunBeginCompare
+      {
+      bool operator()(OffsetValueType offset, Run const & run) const
+        {
+        return offset < run.Begin;
+        }
+      };
+
+    /**
+     * @brief Return the bit of a point, or the number of bits if the point is
+     * outside of the runs. The runs of the line of the point are searched by
+     * bisection.
+     */
+    unsigned long FindBit(OffsetValueType offset) const;
+
+    OffsetValueType m_LineLength;
+
+    /** @brief First run of each line, and end of the runs of the last line. */
+    std::vector<unsigned long> m_LineRuns;
+    unsigned long m_NumberOfIndexedLines;
+
+    std::vector<Run> m_Runs;
+    std::vector<bool> m_Bits;
+  };
+
+}
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkRunIndexedBitmap.txx"
+#endif
+
+#endif // itkRunIndexedBitmap_h
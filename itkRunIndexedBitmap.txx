@@ -0,0 +1,149 @@
+#ifndef itkRunIndexedBitmap_txx
+#define itkRunIndexedBitmap_txx
+
+#include <algorithm>
+
+#include "itkRunIndexedBitmap.h"
+
+namespace itk
+{
+
+template<typename TImage>
+RunIndexedBitmap<TImage>
+::RunIndexedBitmap()
+: m_LineLength(1), m_NumberOfIndexedLines(0)
+  {
+  }
+
+
+template<typename TImage>
+void
+RunIndexedBitmap<TImage>
+::Initialize(SizeType const & size)
+  {
+  m_LineLength = size[0];
+  unsigned long numberOfLines = 1;
+  for(unsigned int j=1; j<TImage::ImageDimension; ++j)
+    {
+    numberOfLines *= size[j];
+    }
+  
+  m_LineRuns.assign(numberOfLines+1, 0);
+  m_NumberOfIndexedLines = 0;
+  m_Runs.clear();
+  m_Bits.clear();
+  }
+
+
+template<typename TImage>
+void
+RunIndexedBitmap<TImage>
+::AddRun(OffsetValueType begin, OffsetValueType end)
+  {
+  // The lines up to the one of the run start at the current run
+  unsigned long const line = begin / m_LineLength;
+  while(m_NumberOfIndexedLines <= line)
+    {
+    m_LineRuns[m_NumberOfIndexedLines] = m_Runs.size();
+    ++m_NumberOfIndexedLines;
+    }
+  
+  Run run;
+  run.Begin = begin;
+  run.End = end;
+  run.Bit = m_Bits.size();
+  m_Runs.push_back(run);
+  m_Bits.resize(m_Bits.size() + (end-begin), true);
+  }
+
+
+template<typename TImage>
+void
+RunIndexedBitmap<TImage>
+::Finalize()
+  {
+  while(m_NumberOfIndexedLines < m_LineRuns.size())
+    {
+    m_LineRuns[m_NumberOfIndexedLines] = m_Runs.size();
+    ++m_NumberOfIndexedLines;
+    }
+  }
+
+
+template<typename TImage>
+bool
+RunIndexedBitmap<TImage>
+::IsSet(OffsetValueType offset) const
+  {
+  unsigned long const bit = this->FindBit(offset);
+  return (bit == m_Bits.size()) || m_Bits[bit];
+  }
+
+
+template<typename TImage>
+void
+RunIndexedBitmap<TImage>
+::Set(OffsetValueType offset)
+  {
+  unsigned long const bit = this->FindBit(offset);
+  if(bit != m_Bits.size())
+    {
+    m_Bits[bit] = true;
+    }
+  }
+
+
+template<typename TImage>
+void
+RunIndexedBitmap<TImage>
+::Reset(OffsetValueType offset)
+  {
+  unsigned long const bit = this->FindBit(offset);
+  if(bit != m_Bits.size())
+    {
+    m_Bits[bit] = false;
+    }
+  }
+
+
+template<typename TImage>
+unsigned long
+RunIndexedBitmap<TImage>
+::GetNumberOfRuns() const
+  {
+  return m_Runs.size();
+  }
+
+
+template<typename TImage>
+unsigned long
+RunIndexedBitmap<TImage>
+::GetNumberOfPoints() const
+  {
+  return m_Bits.size();
+  }
+
+
+template<typename TImage>
+unsigned long
+RunIndexedBitmap<TImage>
+::FindBit(OffsetValueType offset) const
+  {
+  // The runs of a line are sorted and disjoint : the run holding the point,
+  // if any, is the last one beginning at or before it.
+  unsigned long const line = offset / m_LineLength;
+  typename std::vector<Run>::const_iterator const first = 
+    m_Runs.begin() + m_LineRuns[line];
+  typename std::vector<Run>::const_iterator const run = 
+    std::upper_bound(first, m_Runs.begin() + m_LineRuns[line+1], offset, 
+                     RunBeginCompare());
+  if(run != first && offset < (run-1)->End)
+    {
+    return (run-1)->Bit + (offset - (run-1)->Begin);
+    }
+  return m_Bits.size();
+  }
+
+}
+
+#endif // itkRunIndexedBitmap_txx
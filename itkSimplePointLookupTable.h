@@ -0,0 +1,138 @@
+#ifndef itkSimplePointLookupTable_h
+#define itkSimplePointLookupTable_h
+
+#include <vector>
+
+#include <itkSimpleFastMutexLock.h>
+
+#include "itkBackgroundConnectivity.h"
+#include "itkUnitCubeNeighbors.h"
+
+namespace itk
+{
+
+/**
+ * @brief Table of the simple points, indexed by the configuration of the
+ * neighborhood.
+ *
+ * The configuration of a point is the set of its foreground neighbors in the
+ * unit cube, packed in an integer : bit i is set iff the i-th point of the
+ * cube is in the foreground, the center being skipped (the points after the
+ * center are thus shifted by one). The points are numbered as in
+ * Connectivity::OffsetToPoint, i.e. the first coordinate varies fastest.
+ *
+ * A point is simple iff both its foreground and background topological
+ * numbers are equal to 1. The topological numbers are computed with the same
+ * adjacency relations as UnitCubeCCCounter, but on bitmasks : each component
+ * is grown with one OR per point instead of one test per pair of points.
+ *
+ * The table holds one bit per configuration, that is 32 bytes in 2D and 8 MB
+ * in 3D. It is shared by all the users of a connectivity pair. Since filling
+ * 2^26 entries takes a few seconds, the table is filled by blocks of 2^12
+ * configurations, the first time a configuration of the block is requested.
+ * Filling a block is protected by a lock, so the table may be used by
+ * several threads.
+ *
+ * Only the dimensions up to 3 are supported, since the configuration must fit
+ * in an unsigned long.
+ */
+template<typename TForegroundConnectivity,
+         typename TBackgroundConnectivity =
+           typename BackgroundConnectivity<TForegroundConnectivity>::Type >
+class ITK_EXPORT SimplePointLookupTable
+  {
+  public :
+    typedef SimplePointLookupTable Self;
+
+    /** @brief Type of a packed neighborhood configuration. */
+    typedef unsigned long ConfigurationType;
+
+    itkStaticConstMacro(Dimension, unsigned int,
+                        TForegroundConnectivity::Dimension);
+
+    /** @brief Number of points in the unit cube, center included. */
+    itkStaticConstMacro(NeighborhoodSize, unsigned int,
+                        UnitCubeSize<TForegroundConnectivity::Dimension>::Value);
+
+    /** @brief Number of bits in a configuration. */
+    itkStaticConstMacro(NumberOfBits, unsigned int, NeighborhoodSize-1);
+
+    /** @brief Number of configurations. */
+    itkStaticConstMacro(NumberOfConfigurations, ConfigurationType,
+                        ConfigurationType(1) << NumberOfBits);
+
+    /** @brief Return the table of the connectivity pair. */
+    static Self const & GetInstance();
+
+    /** @brief Test if a point with given configuration is simple. */
+    bool IsSimple(ConfigurationType configuration) const;
+
+    /**
+     * @name Topological numbers
+     *
+     * These functions compute, without using the table, the topological
+     * numbers of a point with given configuration.
+     */
+    //@{
+    unsigned int
+      ComputeForegroundTopologicalNumber(ConfigurationType configuration) const;
+
+    unsigned int
+      ComputeBackgroundTopologicalNumber(ConfigurationType configuration) const;
+    //@}
+
+  private :
+    /** @brief Configurations are computed by blocks of 2^BlockBits. */
+    itkStaticConstMacro(BlockBits, unsigned int,
+                        (NumberOfBits < 12) ? NumberOfBits : 12);
+
+    itkStaticConstMacro(WordBits, unsigned int, 32);
+
+    typedef unsigned int WordType;
+
+    SimplePointLookupTable();
+    SimplePointLookupTable(Self const &); // Purposedly not implemented
+    Self & operator=(Self const &); // Purposedly not implemented
+
+    void ComputeBlock(ConfigurationType block) const;
+
+    /**
+     * @brief Count the components of the unit cube image `image` (one bit per
+     * point, center included) containing a point of `seeds`.
+     */
+    static unsigned int CountComponents(ConfigurationType image,
+                                        ConfigurationType seeds,
+                                        ConfigurationType const * adjacency);
+
+    template<typename TConnectivity>
+    static void CreateAdjacency(ConfigurationType & seeds,
+                                ConfigurationType * adjacency);
+
+    /** @brief Position of the lowest set bit, x must not be 0. */
+    static unsigned int LowestBit(ConfigurationType x);
+
+    /** @brief Read and write the flag of a block shared between threads. */
+    static bool IsBlockComputed(char const & flag);
+    static void SetBlockComputed(char & flag);
+
+    /** @brief Insert the (null) center bit in a configuration. */
+    static ConfigurationType Expand(ConfigurationType configuration);
+
+    ConfigurationType m_ForegroundSeeds;
+    ConfigurationType m_ForegroundAdjacency[NeighborhoodSize];
+    ConfigurationType m_BackgroundSeeds;
+    ConfigurationType m_BackgroundAdjacency[NeighborhoodSize];
+
+    mutable std::vector<WordType> m_Table;
+    mutable std::vector<char> m_BlockComputed;
+    mutable SimpleFastMutexLock m_Lock;
+  };
+
+}
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSimplePointLookupTable.txx"
+#endif
+
+#endif // itkSimplePointLookupTable_h
@@ -0,0 +1,250 @@
+#ifndef itkSimplePointLookupTable_txx
+#define itkSimplePointLookupTable_txx
+
+#include "itkSimplePointLookupTable.h"
+
+#include "itkNeighborhoodConnectivity.h"
+
+namespace itk
+{
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::SimplePointLookupTable()
+: m_BlockComputed(NumberOfConfigurations >> BlockBits, 0)
+  {
+  Self::template CreateAdjacency<TForegroundConnectivity>(
+    m_ForegroundSeeds, m_ForegroundAdjacency);
+  Self::template CreateAdjacency<TBackgroundConnectivity>(
+    m_BackgroundSeeds, m_BackgroundAdjacency);
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity> const &
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::GetInstance()
+  {
+  static Self const instance;
+  return instance;
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+bool
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::IsSimple(ConfigurationType configuration) const
+  {
+  ConfigurationType const block = configuration >> BlockBits;
+  if( !IsBlockComputed(m_BlockComputed[block]) )
+    {
+    m_Lock.Lock();
+    if( !m_BlockComputed[block] )
+      {
+      this->ComputeBlock(block);
+      }
+    m_Lock.Unlock();
+    }
+
+  return (m_Table[configuration/WordBits] >> (configuration%WordBits)) & 1;
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+unsigned int
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::ComputeForegroundTopologicalNumber(ConfigurationType configuration) const
+  {
+  return CountComponents(Expand(configuration),
+                         m_ForegroundSeeds, m_ForegroundAdjacency);
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+unsigned int
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::ComputeBackgroundTopologicalNumber(ConfigurationType configuration) const
+  {
+  // Invert the configuration, the center staying out of the image.
+  ConfigurationType const background =
+    ~configuration & (NumberOfConfigurations-1);
+  return CountComponents(Expand(background),
+                         m_BackgroundSeeds, m_BackgroundAdjacency);
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+void
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::ComputeBlock(ConfigurationType block) const
+  {
+  // The table is allocated with its first block, so that the users of the
+  // topological numbers only do not pay for it.
+  if(m_Table.empty())
+    {
+    m_Table.resize(NumberOfConfigurations/WordBits + 1, 0);
+    }
+
+  ConfigurationType const begin = block << BlockBits;
+  ConfigurationType const end = begin + (ConfigurationType(1) << BlockBits);
+  for(ConfigurationType configuration = begin;
+      configuration != end; ++configuration)
+    {
+    if(this->ComputeForegroundTopologicalNumber(configuration) == 1 &&
+       this->ComputeBackgroundTopologicalNumber(configuration) == 1)
+      {
+      m_Table[configuration/WordBits] |=
+        WordType(1) << (configuration%WordBits);
+      }
+    }
+
+  SetBlockComputed(m_BlockComputed[block]);
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+unsigned int
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::CountComponents(ConfigurationType image, ConfigurationType seeds,
+                  ConfigurationType const * adjacency)
+  {
+  unsigned int nbCC = 0;
+  ConfigurationType remainingSeeds = image & seeds;
+  while(remainingSeeds != 0)
+    {
+    ++nbCC;
+
+    // Grow the component from the lowest remaining seed
+    ConfigurationType component = remainingSeeds & (~remainingSeeds + 1);
+    ConfigurationType front = component;
+    while(front != 0)
+      {
+      unsigned int const point = LowestBit(front);
+      front &= front - 1;
+
+      ConfigurationType const added = adjacency[point] & image & ~component;
+      component |= added;
+      front |= added;
+      }
+
+    remainingSeeds &= ~component;
+    }
+
+  return nbCC;
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+template<typename TConnectivity>
+void
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::CreateAdjacency(ConfigurationType & seeds, ConfigurationType * adjacency)
+  {
+  // Same relations as UnitCubeCCCounter : a component is seeded by the
+  // TConnectivity-neighbors of the center, and grown through the unit cube
+  // neighbors.
+  typedef typename NeighborhoodConnectivity<TConnectivity>::Type
+    NeighborhoodConnectivityType;
+  TConnectivity const & connectivity = TConnectivity::GetInstance();
+  UnitCubeNeighbors<TConnectivity, NeighborhoodConnectivityType> const
+    unitCubeNeighbors;
+
+  seeds = 0;
+  for(unsigned int i=0; i<NeighborhoodSize; ++i)
+    {
+    if(connectivity.IsInNeighborhood(i))
+      {
+      seeds |= ConfigurationType(1) << i;
+      }
+
+    adjacency[i] = 0;
+    for(unsigned int j=0; j<NeighborhoodSize; ++j)
+      {
+      if(unitCubeNeighbors(i, j))
+        {
+        adjacency[i] |= ConfigurationType(1) << j;
+        }
+      }
+    }
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+unsigned int
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::LowestBit(ConfigurationType x)
+  {
+#if defined(__GNUC__)
+  return __builtin_ctzl(x);
+#else
+  unsigned int bit = 0;
+  while( (x & 1) == 0 )
+    {
+    x >>= 1;
+    ++bit;
+    }
+  return bit;
+#endif
+  }
+
+
+// The flag of a block is read without the lock : it must be published after
+// the content of the block, and read before it.
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+bool
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::IsBlockComputed(char const & flag)
+  {
+  return __atomic_load_n(&flag, __ATOMIC_ACQUIRE) != 0;
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+void
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::SetBlockComputed(char & flag)
+  {
+  __atomic_store_n(&flag, 1, __ATOMIC_RELEASE);
+  }
+#else
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+bool
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::IsBlockComputed(char const & flag)
+  {
+  bool const computed = (*static_cast<char const volatile *>(&flag) != 0);
+#if defined(__GNUC__)
+  __sync_synchronize();
+#endif
+  return computed;
+  }
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+void
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::SetBlockComputed(char & flag)
+  {
+#if defined(__GNUC__)
+  __sync_synchronize();
+#endif
+  *static_cast<char volatile *>(&flag) = 1;
+  }
+#endif
+
+
+template<typename TForegroundConnectivity, typename TBackgroundConnectivity>
+typename SimplePointLookupTable<TForegroundConnectivity,
+                                TBackgroundConnectivity>::ConfigurationType
+SimplePointLookupTable<TForegroundConnectivity, TBackgroundConnectivity>
+::Expand(ConfigurationType configuration)
+  {
+  ConfigurationType const low =
+    (ConfigurationType(1) << (NeighborhoodSize/2)) - 1;
+  return (configuration & low) | ((configuration & ~low) << 1);
+  }
+
+}
+
+#endif // itkSimplePointLookupTable_txx
@@ -4,11 +4,20 @@
 #include "itkBinaryImageFunction.h"
 
 #include "itkBackgroundConnectivity.h"
+#include "itkSimplePointLookupTable.h"
 #include "itkTopologicalNumberImageFunction.h"
 
 namespace itk
 {
 
+/**
+ * @brief Test if a point is simple, i.e. if both its topological numbers are
+ * equal to 1.
+ *
+ * In 2D and 3D, the simplicity is read in a SimplePointLookupTable indexed by
+ * the configuration of the neighborhood. In higher dimensions, the
+ * topological numbers are computed by TopologicalNumberImageFunction.
+ */
 template<typename TImage, 
          typename TForegroundConnectivity, 
          typename TBackgroundConnectivity = 
@@ -34,10 +43,18 @@ class ITK_EXPORT SimplicityByTopologicalNumbersImageFunction :
     typedef typename Superclass::PointType PointType;
     typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
     typedef typename Superclass::IndexType IndexType;
+    typedef typename Superclass::OffsetValueType OffsetValueType;
     
     typedef typename Superclass::InputImageType InputImageType;
     typedef typename Superclass::InputPixelType InputPixelType;
+    typedef typename Superclass::ConfigurationType ConfigurationType;
     //@}
+
+    /**
+     * @brief Table of the simple points, used up to the dimension 3.
+     */
+    typedef SimplePointLookupTable<TForegroundConnectivity,
+                                   TBackgroundConnectivity> LookupTableType;
     
     /**
      * @brief Initialize the functor so that the topological numbers are 
@@ -56,6 +73,41 @@ class ITK_EXPORT SimplicityByTopologicalNumbersImageFunction :
     bool EvaluateAtIndex(IndexType const & index) const;
     
     bool EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const;
+    
+    /** 
+     * @brief Evaluate the simplicity at an offset of the buffer. This 
+     * function is not virtual, so that it may be inlined when the type of 
+     * the functor is known, e.g. by SkeletonizeImageFilter.
+     */
+    bool EvaluateAtOffset(OffsetValueType offset) const;
+    
+    /**
+     * @brief Evaluate the simplicity at an offset of the buffer, with the 
+     * given foreground value instead of the one of the function, e.g. for 
+     * the label of the point in a label map. Only up to the dimension 3.
+     */
+    bool EvaluateAtOffset(OffsetValueType offset, 
+                          InputPixelType const & foregroundValue) const;
+    
+    /**
+     * @brief Evaluate the simplicity on the configuration gathered around a
+     * point, reading the lookup table. Only up to the dimension 3.
+     */
+    bool EvaluateConfiguration(ConfigurationType configuration) const;
+    
+    /** 
+     * @brief Batch evaluation, reading the lookup table for the 
+     * configurations of the points gathered at once.
+     */
+    void EvaluateAtOffsets(OffsetValueType const * offsets, 
+                           unsigned long count, bool * results) const;
+    
+    /** @brief Batch evaluation at indices, through EvaluateAtOffsets. */
+    void EvaluateAtIndices(IndexType const * indices, unsigned long count,
+                           bool * results) const
+      {
+      this->EvaluateAtIndicesByOffsets(indices, count, results);
+      }
     //@}
     
     void SetInputImage(InputImageType const * ptr)
@@ -69,9 +121,24 @@ class ITK_EXPORT SimplicityByTopologicalNumbersImageFunction :
   private :
     SimplicityByTopologicalNumbersImageFunction(Self const &); //not implemented
     Self & operator=(Self const &); // not implemented
-    typename TopologicalNumberImageFunction<TImage, 
 
-      TForegroundConnectivity>::Pointer m_TnCounter;
+    /** @brief Tag selecting the evaluation through the lookup table. */
+    template<bool VUseLookupTable>
+    struct UseLookupTable {};
+
+    bool EvaluateAtIndex(IndexType const & index, UseLookupTable<true>) const;
+    bool EvaluateAtIndex(IndexType const & index, UseLookupTable<false>) const;
+
+    bool EvaluateAtOffset(OffsetValueType offset, UseLookupTable<true>) const;
+    bool EvaluateAtOffset(OffsetValueType offset, UseLookupTable<false>) const;
+
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           bool * results, UseLookupTable<true>) const;
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           bool * results, UseLookupTable<false>) const;
+
+    typename TopologicalNumberImageFunction<TImage, TForegroundConnectivity,
+      TBackgroundConnectivity>::Pointer m_TnCounter;
   };
 
 }
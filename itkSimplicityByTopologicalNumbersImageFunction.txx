@@ -1,6 +1,7 @@
 #ifndef itkSimplicityByTopologicalNumbersImageFunction_txx
 #define itkSimplicityByTopologicalNumbersImageFunction_txx
 
+#include <algorithm>
 
 #include "itkSimplicityByTopologicalNumbersImageFunction.h"
 
@@ -18,7 +19,7 @@ SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity,
   {
   m_TnCounter = TopologicalNumberImageFunction<TImage, 
 
-                  TForegroundConnectivity>::New();
+                  TForegroundConnectivity, TBackgroundConnectivity>::New();
   }
 
 template<typename TImage, typename TForegroundConnectivity, 
@@ -31,7 +32,7 @@ SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity,
 ::Evaluate(PointType const & point) const
   {
   typename TImage::IndexType index;
-  ConvertPointToNearestIndex(point, index);
+  this->ConvertPointToNearestIndex(point, index);
   return EvaluateAtIndex(index);
   }
 
@@ -45,13 +46,148 @@ SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity,
                                             TBackgroundConnectivity>
 ::EvaluateAtIndex(IndexType const & index) const
   {
-  std::pair<unsigned char, unsigned char> const result = 
+  return this->EvaluateAtIndex(index,
 
+    UseLookupTable<(TImage::ImageDimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseLookupTable<true>) const
+  {
+  typename LookupTableType::ConfigurationType const configuration = 
+    this->m_NeighborhoodConfiguration.GatherAtIndex(index, 
+                                                    this->m_ForegroundValue);
+  return LookupTableType::GetInstance().IsSimple(configuration);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseLookupTable<false>) const
+  {
+  std::pair<unsigned int, unsigned int> const result = 
     m_TnCounter->EvaluateAtIndex(index);
   return (result.first==1 && result.second==1);
   }
 
 
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset) const
+  {
+  return this->EvaluateAtOffset(offset, 
+    UseLookupTable<(TImage::ImageDimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, UseLookupTable<true>) const
+  {
+  return this->EvaluateAtOffset(offset, this->m_ForegroundValue);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, 
+                   InputPixelType const & foregroundValue) const
+  {
+  return this->EvaluateConfiguration(
+    this->m_NeighborhoodConfiguration.Gather(offset, foregroundValue));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateConfiguration(ConfigurationType configuration) const
+  {
+  return LookupTableType::GetInstance().IsSimple(configuration);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+bool
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, UseLookupTable<false>) const
+  {
+  return this->EvaluateAtIndex(this->GetInputImage()->ComputeIndex(offset), 
+                               UseLookupTable<false>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+void
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count, 
+                    bool * results) const
+  {
+  this->EvaluateAtOffsets(offsets, count, results, 
+    UseLookupTable<(TImage::ImageDimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+void
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count, 
+                    bool * results, UseLookupTable<true>) const
+  {
+  LookupTableType const & table = LookupTableType::GetInstance();
+  typename LookupTableType::ConfigurationType 
+    configurations[Superclass::BatchSize];
+  for(unsigned long batch = 0; batch < count; batch += Superclass::BatchSize)
+    {
+    unsigned long const batchCount = 
+      std::min<unsigned long>(Superclass::BatchSize, count - batch);
+    this->m_NeighborhoodConfiguration.Gather(offsets + batch, batchCount, 
+      this->m_ForegroundValue, configurations);
+    for(unsigned long i = 0; i < batchCount; ++i)
+      {
+      results[batch+i] = table.IsSimple(configurations[i]);
+      }
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TBackgroundConnectivity >
+void
+SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, 
+                                            TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count, 
+                    bool * results, UseLookupTable<false>) const
+  {
+  this->Superclass::EvaluateAtOffsets(offsets, count, results);
+  }
+
+
 template<typename TImage, typename TForegroundConnectivity, typename TBackgroundConnectivity >
 void
 SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity, TBackgroundConnectivity>
@@ -71,7 +207,7 @@ SimplicityByTopologicalNumbersImageFunction<TImage, TForegroundConnectivity,
 ::EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const
   {
   typename TImage::IndexType index;
-  ConvertContinuousIndexToNearestIndex(contIndex, index);
+  this->ConvertContinuousIndexToNearestIndex(contIndex, index);
   return EvaluateAtIndex(index);
   }
 
@@ -0,0 +1,114 @@
+#ifndef itkSkeletonGraph_h
+#define itkSkeletonGraph_h
+
+#include <vector>
+
+#include <itkDataObject.h>
+#include <itkIndex.h>
+#include <itkObjectFactory.h>
+
+namespace itk
+{
+
+/**
+ * @brief Graph of a skeleton : the nodes are its end points and junction
+ * points, the edges are the chains of points between them.
+ *
+ * A node is an end point, i.e. a point of the skeleton with less than 2 
+ * neighbors in the skeleton, or a junction, i.e. a connected set of points 
+ * with more than 2 neighbors, e.g. the points of a crossing, located at its
+ * point nearest to the center of the set ; its degree is its number of edge
+ * ends. A closed curve without such points gets one node of degree 2, linked
+ * to itself. The points of an edge are the points of its chain between the 
+ * source and the target, excluded, in order from the source : an edge 
+ * between neighbor nodes, e.g. a spur of a single point, has no points.
+ * The length of an edge is the length of the chain from the point of the
+ * source it leaves to the point of the target it reaches, in physical
+ * units.
+ *
+ * @sa SkeletonToGraphFilter
+ */
+template<unsigned int VDimension>
+class ITK_EXPORT SkeletonGraph : public DataObject
+  {
+  public :
+    /**
+     * @name Standard ITK declarations
+     */
+    //@{
+    typedef SkeletonGraph Self;
+    typedef DataObject Superclass;
+    typedef SmartPointer<Self> Pointer;
+    typedef SmartPointer<Self const> ConstPointer;
+
+    itkNewMacro(Self);
+    itkTypeMacro(SkeletonGraph, DataObject);
+    //@}
+
+    itkStaticConstMacro(Dimension, unsigned int, VDimension);
+
+    typedef Index<VDimension> IndexType;
+
+    struct Node
+      {
+      IndexType Index;
+      unsigned int Degree;
+      };
+
+    struct Edge
+      {
+      unsigned long Source;
+      unsigned long Target;
+      double Length;
+      std::vector<IndexType> Points;
+      };
+
+    /** @brief Remove all the nodes and edges. */
+    void Initialize()
+      {
+      Superclass::Initialize();
+      m_Nodes.clear();
+      m_Edges.clear();
+      }
+
+    /** @brief Add a node, return its number. */
+    unsigned long AddNode(Node const & node)
+      {
+      m_Nodes.push_back(node);
+      return m_Nodes.size()-1;
+      }
+
+    /** @brief Add an edge, return its number. */
+    unsigned long AddEdge(Edge const & edge)
+      {
+      m_Edges.push_back(edge);
+      return m_Edges.size()-1;
+      }
+
+    unsigned long GetNumberOfNodes() const { return m_Nodes.size(); }
+    unsigned long GetNumberOfEdges() const { return m_Edges.size(); }
+
+    Node const & GetNode(unsigned long node) const { return m_Nodes[node]; }
+    Edge const & GetEdge(unsigned long edge) const { return m_Edges[edge]; }
+
+  protected :
+    SkeletonGraph() {}
+
+    void PrintSelf(std::ostream& os, Indent indent) const
+      {
+      Superclass::PrintSelf(os, indent);
+      os << indent << "NumberOfNodes: " << m_Nodes.size() << std::endl;
+      os << indent << "NumberOfEdges: " << m_Edges.size() << std::endl;
+      }
+
+  private :
+    SkeletonGraph(Self const &); // not implemented
+    Self & operator=(Self const &); // not implemented
+
+    std::vector<Node> m_Nodes;
+    std::vector<Edge> m_Edges;
+  };
+
+}
+
+#endif // itkSkeletonGraph_h
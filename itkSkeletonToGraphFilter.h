@@ -0,0 +1,149 @@
+#ifndef itkSkeletonToGraphFilter_h
+#define itkSkeletonToGraphFilter_h
+
+#include <vector>
+
+#include <itkProcessObject.h>
+
+#include "itkSkeletonGraph.h"
+
+namespace itk
+{
+
+/**
+ * @brief Build the graph of a skeleton, e.g. the output of
+ * SkeletonizeImageFilter.
+ *
+ * @param TImage the type of the skeleton image
+ * @param TForegroundConnectivity the connectivity of the skeleton
+ *
+ * The points of the skeleton, i.e. the points with the foreground value, are
+ * listed with a single scan of the image, in increasing order of offset. The
+ * neighbors of the points along a step of the foreground connectivity are 
+ * found by a merge of this list with itself shifted by the step : the rest 
+ * of the work, the lookup of the neighbors, the grouping of the neighbor 
+ * junction points in nodes and the tracing of the chains between them, is 
+ * linear in the number of points of the skeleton for a given connectivity, 
+ * and the memory grows with the number of points of the skeleton, not with 
+ * the size of the image.
+ *
+ * The lengths of the edges use the spacing of the image.
+ *
+ * @sa SkeletonGraph
+ */
+template<typename TImage, typename TForegroundConnectivity>
+class ITK_EXPORT SkeletonToGraphFilter : public ProcessObject
+  {
+  public :
+    /**
+     * @name Standard ITK declarations
+     */
+    //@{
+    typedef SkeletonToGraphFilter Self;
+    typedef ProcessObject Superclass;
+    typedef SmartPointer<Self> Pointer;
+    typedef SmartPointer<Self const> ConstPointer;
+
+    itkNewMacro(Self);
+    itkTypeMacro(SkeletonToGraphFilter, ProcessObject);
+    //@}
+
+    typedef TImage InputImageType;
+    typedef typename InputImageType::PixelType InputPixelType;
+    typedef typename InputImageType::IndexType IndexType;
+    typedef typename InputImageType::OffsetType OffsetType;
+    typedef typename InputImageType::OffsetValueType OffsetValueType;
+
+    typedef SkeletonGraph<InputImageType::ImageDimension> GraphType;
+
+    /** @brief Connectivity used in the skeleton. */
+    typedef TForegroundConnectivity ForegroundConnectivity;
+
+    void SetInput(InputImageType const * image);
+    InputImageType const * GetInput() const;
+
+    GraphType * GetOutput();
+
+    /** Set/Get the foreground value. Defaults to max */
+    itkSetMacro(ForegroundValue, InputPixelType);
+    itkGetMacro(ForegroundValue, InputPixelType);
+
+  protected :
+    SkeletonToGraphFilter();
+
+    void PrintSelf(std::ostream& os, Indent indent) const;
+
+    /** @brief The whole skeleton is needed. */
+    void GenerateInputRequestedRegion();
+
+    void GenerateData();
+
+  private :
+    SkeletonToGraphFilter(Self const &); // not implemented
+    Self & operator=(Self const &); // not implemented
+
+    /** @brief Number of the points which are not nodes. */
+    static unsigned long const NoNode = static_cast<unsigned long>(-1);
+
+    /** @brief Number of neighbors of a point of the skeleton. */
+    unsigned int GetDegree(unsigned long point) const
+      {
+      return m_FirstNeighbor[point+1] - m_FirstNeighbor[point];
+      }
+
+    /** @brief Test if a point has more than 2 neighbors. */
+    bool IsJunction(unsigned long point) const
+      {
+      return this->GetDegree(point) > 2;
+      }
+
+    /**
+     * @brief Number of the point at each point shifted by a step, or NoNode
+     * if it is not in the skeleton or out of the buffer.
+     */
+    void MatchStep(OffsetValueType step, OffsetType const & neighbor,
+                   std::vector<bool> const & onBorder,
+                   std::vector<unsigned long> & matches) const;
+
+    /**
+     * @brief Node of an end point, or of a connected set of junction points,
+     * the points being numbered with the node.
+     */
+    typename GraphType::Node
+    MakeNode(std::vector<unsigned long> const & cluster) const;
+
+    /**
+     * @brief Add the edges from a point of a node through its neighbors that
+     * were not traced yet, i.e. the points of its chains that are not
+     * visited, and the points of other nodes with a larger number.
+     */
+    void TraceEdges(unsigned long start);
+
+    InputPixelType m_ForegroundValue;
+
+    /**
+     * @name State of the update
+     *
+     * The points of the skeleton are numbered in raster order ; the
+     * neighbors of point i are neighbors[first[i]], ...,
+     * neighbors[first[i+1]-1], with the length of the step to each of them.
+     */
+    //@{
+    std::vector<OffsetValueType> m_Points;
+    std::vector<unsigned long> m_FirstNeighbor;
+    std::vector<unsigned long> m_Neighbors;
+    std::vector<double> m_StepLengths;
+    std::vector<unsigned long> m_Nodes;
+    std::vector<bool> m_Visited;
+    //@}
+  };
+
+}
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSkeletonToGraphFilter.txx"
+
+#endif
+
+#endif // itkSkeletonToGraphFilter_h
@@ -0,0 +1,376 @@
+#ifndef itkSkeletonToGraphFilter_txx
+#define itkSkeletonToGraphFilter_txx
+
+#include <cmath>
+
+#include <itkNumericTraits.h>
+
+#include "itkSkeletonToGraphFilter.h"
+
+namespace itk
+{
+
+template<typename TImage, typename TForegroundConnectivity>
+unsigned long const
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>::NoNode;
+
+
+template<typename TImage, typename TForegroundConnectivity>
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::SkeletonToGraphFilter()
+  {
+  this->SetNumberOfRequiredInputs(1);
+  this->SetNumberOfRequiredOutputs(1);
+  typename GraphType::Pointer output = GraphType::New();
+  this->SetNthOutput(0, output.GetPointer());
+  m_ForegroundValue = NumericTraits<InputPixelType>::max();
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+void
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::SetInput(InputImageType const * image)
+  {
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(0, const_cast<InputImageType *>(image));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+typename SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+  ::InputImageType const *
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::GetInput() const
+  {
+  return static_cast<InputImageType const *>(
+    this->ProcessObject::GetInput(0));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+typename SkeletonToGraphFilter<TImage, TForegroundConnectivity>::GraphType *
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::GetOutput()
+  {
+  return static_cast<GraphType *>(this->ProcessObject::GetOutput(0));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+void
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::PrintSelf(std::ostream& os, Indent indent) const
+  {
+  Superclass::PrintSelf(os, indent);
+  os << indent
+     << "Cell dimension used for foreground connectivity: "
+     << ForegroundConnectivity::CellDimension << std::endl;
+  os << indent << "ForegroundValue: "
+     << static_cast<typename NumericTraits<InputPixelType>::PrintType>(
+          m_ForegroundValue)
+     << std::endl;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+void
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::GenerateInputRequestedRegion()
+  {
+  Superclass::GenerateInputRequestedRegion();
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if(input)
+    {
+    input->SetRequestedRegion(input->GetLargestPossibleRegion());
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+void
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::GenerateData()
+  {
+  InputImageType const * const image = this->GetInput();
+  GraphType * const graph = this->GetOutput();
+  graph->Initialize();
+
+  typename InputImageType::RegionType const & region =
+    image->GetBufferedRegion();
+  InputPixelType const * const buffer = image->GetBufferPointer();
+
+  // Offsets and physical lengths of the steps to the neighbors
+  ForegroundConnectivity const & connectivity =
+    ForegroundConnectivity::GetInstance();
+  std::vector<OffsetType> neighbors(connectivity.GetNumberOfNeighbors());
+  std::vector<OffsetValueType> neighborOffsets(neighbors.size());
+  std::vector<double> neighborLengths(neighbors.size());
+  for(unsigned int i = 0; i < neighbors.size(); ++i)
+    {
+    double squaredLength = 0;
+    for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+      {
+      neighbors[i][j] = connectivity.GetNeighborsPoints()[i][j];
+      double const step = neighbors[i][j] * image->GetSpacing()[j];
+      squaredLength += step*step;
+      }
+    neighborOffsets[i] =
+      image->ComputeOffset(region.GetIndex() + neighbors[i]);
+    neighborLengths[i] = std::sqrt(squaredLength);
+    }
+
+  // List the points of the skeleton, in increasing order of offset, and 
+  // flag the points on the border of the buffer.
+  m_Points.clear();
+  std::vector<bool> onBorder;
+  OffsetValueType const size = region.GetNumberOfPixels();
+  for(OffsetValueType offset = 0; offset < size; ++offset)
+    {
+    if(buffer[offset] != m_ForegroundValue)
+      {
+      continue;
+      }
+    IndexType const index = image->ComputeIndex(offset);
+    bool border = false;
+    for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+      {
+      long const first = region.GetIndex()[j];
+      long const last = first + static_cast<long>(region.GetSize()[j]) - 1;
+      if(index[j] == first || index[j] == last)
+        {
+        border = true;
+        }
+      }
+    m_Points.push_back(offset);
+    onBorder.push_back(border);
+    }
+
+  // Neighbors of each point : the points are counted in a first pass over 
+  // the steps of the connectivity, and stored in a second one.
+  m_FirstNeighbor.assign(m_Points.size()+1, 0);
+  std::vector<unsigned long> matches;
+  for(unsigned int i = 0; i < neighbors.size(); ++i)
+    {
+    this->MatchStep(neighborOffsets[i], neighbors[i], onBorder, matches);
+    for(unsigned long point = 0; point < m_Points.size(); ++point)
+      {
+      m_FirstNeighbor[point+1] += (matches[point] != NoNode);
+      }
+    }
+  for(unsigned long point = 0; point < m_Points.size(); ++point)
+    {
+    m_FirstNeighbor[point+1] += m_FirstNeighbor[point];
+    }
+  m_Neighbors.resize(m_FirstNeighbor[m_Points.size()]);
+  m_StepLengths.resize(m_Neighbors.size());
+  std::vector<unsigned long> next(m_FirstNeighbor.begin(), 
+                                  m_FirstNeighbor.end()-1);
+  for(unsigned int i = 0; i < neighbors.size(); ++i)
+    {
+    this->MatchStep(neighborOffsets[i], neighbors[i], onBorder, matches);
+    for(unsigned long point = 0; point < m_Points.size(); ++point)
+      {
+      if(matches[point] != NoNode)
+        {
+        m_Neighbors[next[point]] = matches[point];
+        m_StepLengths[next[point]] = neighborLengths[i];
+        ++next[point];
+        }
+      }
+    }
+
+  // The nodes are the end points, and the connected sets of junction 
+  // points : the points of a crossing are neighbors of one another, and make
+  // a single junction. An end point next to a junction stays a node of its 
+  // own.
+  m_Nodes.assign(m_Points.size(), NoNode);
+  m_Visited.assign(m_Points.size(), false);
+  std::vector<unsigned long> cluster;
+  for(unsigned long point = 0; point < m_Points.size(); ++point)
+    {
+    if(m_Nodes[point] != NoNode || this->GetDegree(point) == 2)
+      {
+      continue;
+      }
+    unsigned long const node = graph->GetNumberOfNodes();
+    m_Nodes[point] = node;
+    cluster.assign(1, point);
+    for(unsigned long i = 0; i < cluster.size() && this->IsJunction(point);
+        ++i)
+      {
+      for(unsigned long j = m_FirstNeighbor[cluster[i]];
+          j < m_FirstNeighbor[cluster[i]+1]; ++j)
+        {
+        unsigned long const neighbor = m_Neighbors[j];
+        if(m_Nodes[neighbor] == NoNode && this->IsJunction(neighbor))
+          {
+          m_Nodes[neighbor] = node;
+          cluster.push_back(neighbor);
+          }
+        }
+      }
+    graph->AddNode(this->MakeNode(cluster));
+    }
+  for(unsigned long point = 0; point < m_Points.size(); ++point)
+    {
+    if(m_Nodes[point] != NoNode)
+      {
+      this->TraceEdges(point);
+      }
+    }
+
+  // The points left are on closed curves : the first point of each curve
+  // becomes a node.
+  for(unsigned long point = 0; point < m_Points.size(); ++point)
+    {
+    if(m_Nodes[point] == NoNode && !m_Visited[point])
+      {
+      typename GraphType::Node node;
+      node.Index = image->ComputeIndex(m_Points[point]);
+      node.Degree = 2;
+      m_Nodes[point] = graph->AddNode(node);
+      this->TraceEdges(point);
+      }
+    }
+
+  m_Points.clear();
+  m_FirstNeighbor.clear();
+  m_Neighbors.clear();
+  m_StepLengths.clear();
+  m_Nodes.clear();
+  m_Visited.clear();
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+void
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::MatchStep(OffsetValueType step, OffsetType const & neighbor, 
+            std::vector<bool> const & onBorder, 
+            std::vector<unsigned long> & matches) const
+  {
+  InputImageType const * const image = this->GetInput();
+  typename InputImageType::RegionType const & region = 
+    image->GetBufferedRegion();
+
+  // The points shifted by the step are in increasing order of offset too, 
+  // so the list is merged with itself : the candidate only moves forward.
+  matches.assign(m_Points.size(), NoNode);
+  unsigned long candidate = 0;
+  for(unsigned long point = 0; point < m_Points.size(); ++point)
+    {
+    OffsetValueType const offset = m_Points[point] + step;
+    while(candidate < m_Points.size() && m_Points[candidate] < offset)
+      {
+      ++candidate;
+      }
+    if(candidate == m_Points.size())
+      {
+      break;
+      }
+    if(m_Points[candidate] == offset && 
+       (!onBorder[point] || 
+        region.IsInside(image->ComputeIndex(m_Points[point]) + neighbor)))
+      {
+      matches[point] = candidate;
+      }
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+typename SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+  ::GraphType::Node
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::MakeNode(std::vector<unsigned long> const & cluster) const
+  {
+  InputImageType const * const image = this->GetInput();
+  unsigned int const dimension = InputImageType::ImageDimension;
+
+  // The node is at the point of the cluster nearest to its center ; each
+  // step from the cluster to a point out of it starts an edge.
+  std::vector<double> center(dimension, 0);
+  typename GraphType::Node node;
+  node.Degree = 0;
+  for(unsigned long i = 0; i < cluster.size(); ++i)
+    {
+    IndexType const index = image->ComputeIndex(m_Points[cluster[i]]);
+    for(unsigned int j = 0; j < dimension; ++j)
+      {
+      center[j] += static_cast<double>(index[j]) / cluster.size();
+      }
+    for(unsigned long k = m_FirstNeighbor[cluster[i]];
+        k < m_FirstNeighbor[cluster[i]+1]; ++k)
+      {
+      if(m_Nodes[m_Neighbors[k]] != m_Nodes[cluster[i]])
+        {
+        ++node.Degree;
+        }
+      }
+    }
+  double minimumDistance = 0;
+  for(unsigned long i = 0; i < cluster.size(); ++i)
+    {
+    IndexType const index = image->ComputeIndex(m_Points[cluster[i]]);
+    double distance = 0;
+    for(unsigned int j = 0; j < dimension; ++j)
+      {
+      distance += (index[j]-center[j]) * (index[j]-center[j]);
+      }
+    if(i == 0 || distance < minimumDistance)
+      {
+      minimumDistance = distance;
+      node.Index = index;
+      }
+    }
+  return node;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity>
+void
+SkeletonToGraphFilter<TImage, TForegroundConnectivity>
+::TraceEdges(unsigned long start)
+  {
+  InputImageType const * const image = this->GetInput();
+  GraphType * const graph = this->GetOutput();
+
+  for(unsigned long i = m_FirstNeighbor[start];
+      i < m_FirstNeighbor[start+1]; ++i)
+    {
+    unsigned long current = m_Neighbors[i];
+    if(m_Nodes[current] == m_Nodes[start] || m_Visited[current] || 
+       (m_Nodes[current] != NoNode && current < start))
+      {
+      // Point of the same node, or edge traced from the other end
+      continue;
+      }
+
+    typename GraphType::Edge edge;
+    edge.Source = m_Nodes[start];
+    edge.Length = m_StepLengths[i];
+    unsigned long previous = start;
+    while(m_Nodes[current] == NoNode)
+      {
+      // A point of a chain has two neighbors : go on with the one that is
+      // not the previous point.
+      m_Visited[current] = true;
+      edge.Points.push_back(image->ComputeIndex(m_Points[current]));
+      unsigned long next = m_FirstNeighbor[current];
+      if(m_Neighbors[next] == previous)
+        {
+        ++next;
+        }
+      edge.Length += m_StepLengths[next];
+      previous = current;
+      current = m_Neighbors[next];
+      }
+    edge.Target = m_Nodes[current];
+    graph->AddEdge(edge);
+    }
+  }
+
+}
+
+#endif // itkSkeletonToGraphFilter_txx
@@ -1,9 +1,22 @@
 #ifndef itkSkeletonizationImageFilter_h
 #define itkSkeletonizationImageFilter_h
 
+#include <functional>
+#include <vector>
+
 #include <itkImage.h>
 #include "itkBinaryImageFunction.h"
+#include "itkChamferDistanceTransformImageFilter.h"
+#include "itkConnectivity.h"
+#include "itkHierarchicalQueue.h"
+#include "itkLineTerminalityImageFunction.h"
+#include "itkRunIndexedBitmap.h"
+#include "itkSimplicityByTopologicalNumbersImageFunction.h"
 #include <itkInPlaceImageFilter.h>
+#include <itkMultiThreader.h>
+#include <itkProgressReporter.h>
+#include <itkSimpleFastMutexLock.h>
+#include <itkTimeProbe.h>
 
 namespace itk
 {
@@ -12,14 +25,29 @@ namespace itk
  * @brief Computes the skeleton of an image using homotopic thinning.
  *
  * @param FGC the connectivity used in the foreground
+ * @param TOrderingImage the type of the ordering image
+ * @param TSimplicityPolicy the default simplicity criterion
+ * @param TTerminalityPolicy the default terminality criterion
  *
  * This algorithm needs the following inputs :
  * - An image to be skeletonized
- * - An image to order the removal
+ * - An image to order the removal, or a distance filter computing it
  * - A simplicity criterion
  * - A terminality criterion
  *
- * @pre The object in the image must not touch the border.
+ * @pre The object in the image must not touch the border. The points on the
+ * border of the image are never removed.
+ * @pre The ordering image must have the same buffered region as the output.
+ *
+ * When no ordering image is set, the distance filter is run on the input, 
+ * and its output is used as the ordering : the filter lists the points of 
+ * the object during its last pass, and the queue is initialized from that 
+ * list instead of a scan of the image, the queued points being flagged as 
+ * with SparseInitialization. The list is freed once the queue is built, and 
+ * the distance map, which gives the priority of the points pushed again 
+ * during the thinning, is released after the thinning. The distance filter 
+ * must compute the distance in the object : an exception is thrown if its 
+ * DistanceFromObject is set.
  *
  * If no simplicity criterion is provided, the default is to compute the 
  * topological numbers and to qualify a point as simple iff both numbers are 
@@ -29,8 +57,61 @@ namespace itk
  * If no terminality criterion is provided, the default is to keep the line 
  * terminal points, i.e. points having only one neighbor in the object.
  * @sa itk::LineTerminalityImageFunction
+ *
+ * The default criteria are the policies given as template parameters : they
+ * are called without virtual dispatch in the sequential thinning, so that 
+ * the compiler may inline them. A policy is a BinaryImageFunction with, up 
+ * to the dimension 3, a non-virtual EvaluateConfiguration(ConfigurationType)
+ * member evaluating the function on the unit cube gathered by 
+ * NeighborhoodConfiguration, and in higher dimensions a non-virtual 
+ * EvaluateAtOffset(OffsetValueType) member evaluating it at an offset of the
+ * buffer of its image. The unit cube is gathered once for both policies, 
+ * with the foreground value or, in multi-label mode, with the label of the 
+ * point : the multi-label thinning, which is compiled with every 
+ * instantiation of the filter even if MultiLabel is never set, needs no 
+ * other member, e.g. no EvaluateAtOffset(OffsetValueType, InputPixelType). 
+ * The criteria set at run time go through the virtual functions of 
+ * BinaryImageFunction : if any of them is set, both criteria are evaluated 
+ * this way.
+ *
+ * In parallel mode, the points are processed one level of the ordering image 
+ * at a time instead of one point at a time. The points of a level are split 
+ * in 2^n subfields according to the parity of their coordinates : two points 
+ * of a subfield are never in the unit cube of each other, so their deletions 
+ * are independent, and each subfield is split across the threads. The 
+ * topology is preserved as in the sequential mode, provided that the criteria 
+ * only look at the unit cube around the point and may be evaluated by several 
+ * threads at once; the default criteria do.
+ *
+ * In multi-label mode, the input is a label map : every value but the 
+ * background value is a label, and all the labels are thinned at once, each
+ * one with the points of the other labels as background. The criteria are 
+ * evaluated at each point with its label as foreground value, the deletion 
+ * of a point only queues the points of its label, and the distance filter 
+ * computes the distance in all the labels in a single transform ; the 
+ * skeleton of each label is the same as if it was thinned alone, and the 
+ * cost grows with the number of points in the labels, not with the number 
+ * of labels. Up to the dimension 3, the policies are evaluated on the unit
+ * cube gathered with the label through EvaluateConfiguration ; the 
+ * criteria set at run time, and the policies in higher dimensions, get the
+ * label through SetForegroundValue, and are not supported in parallel mode.
+ *
+ * In componentwise mode, the connected components of the object are thinned
+ * independently, each one on a copy of its bounding box padded by one point,
+ * and the threads take the components from a shared counter, the largest 
+ * first. The components are labeled with the full unit cube connectivity, 
+ * whatever the foreground connectivity : a point of a component is then 
+ * never in the unit cube of a point of another one, the criteria never see 
+ * the other components, and the skeleton is the same as in sequential mode.
  */
-template<typename TImage, typename TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage = 
+           Image<unsigned int, TImage::ImageDimension>,
+         typename TSimplicityPolicy = 
+           SimplicityByTopologicalNumbersImageFunction<TImage, 
+                                                       TForegroundConnectivity>,
+         typename TTerminalityPolicy = 
+           LineTerminalityImageFunction<TImage, TForegroundConnectivity> >
 class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
   {
   public :
@@ -58,12 +139,14 @@ class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
     
     /**
      * @name Define the type of the ordering image.
+     *
+     * The queue is selected by HierarchicalQueue according to the pixel type 
+     * of the ordering image : an 8 or 16 bits ordering, e.g. a saturated 
+     * chamfer distance, uses a vector of buckets indexed by the priority.
      */
     //@{
-    typedef unsigned int OrderingVoxelType;
-    typedef Image<OrderingVoxelType, InputImageType::ImageDimension> 
-
-      OrderingImageType;
+    typedef TOrderingImage OrderingImageType;
+    typedef typename OrderingImageType::PixelType OrderingVoxelType;
     //@}
     
     /**
@@ -71,8 +154,26 @@ class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
      */
     typedef BinaryImageFunction<OutputImageType, bool> Criterion;
     
+    /** @brief Gatherer of the unit cube shared by the default criteria. */
+    typedef typename Criterion::NeighborhoodConfigurationType 
+      NeighborhoodConfigurationType;
+    typedef typename Criterion::ConfigurationType ConfigurationType;
+    
+    /**
+     * @name Types of the default criteria.
+     */
+    //@{
+    typedef TSimplicityPolicy SimplicityPolicyType;
+    typedef TTerminalityPolicy TerminalityPolicyType;
+    //@}
+    
     /** Declaration of pixel type. */
     typedef typename InputImageType::PixelType InputPixelType ;
+    typedef typename InputImageType::IndexType IndexType;
+    typedef typename InputImageType::SizeType SizeType;
+    typedef typename InputImageType::RegionType RegionType;
+    typedef typename InputImageType::OffsetType OffsetType;
+    typedef typename InputImageType::OffsetValueType OffsetValueType;
 
     /** Set/Get the foreground value. Defaults to max */
     itkSetMacro(ForegroundValue, InputPixelType);
@@ -82,6 +183,72 @@ class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
     itkSetMacro(BackgroundValue, InputPixelType);
     itkGetMacro(BackgroundValue, InputPixelType);
 
+    /**
+     * @brief Thin all the labels of a label map at once. Defaults to false.
+     */
+    itkSetMacro(MultiLabel, bool);
+    itkGetConstMacro(MultiLabel, bool);
+    itkBooleanMacro(MultiLabel);
+
+    /**
+     * @brief Process the ordering levels with subfields split across the 
+     * threads. Defaults to false.
+     */
+    itkSetMacro(Parallel, bool);
+    itkGetConstMacro(Parallel, bool);
+    itkBooleanMacro(Parallel);
+
+    /**
+     * @brief Initialize the queue from the runs of the object along the first
+     * axis, and flag the queued points with one bit per point of the runs 
+     * instead of one boolean per point of the image. The memory of the flags 
+     * then grows with the size of the object instead of the size of the 
+     * image, which suits sparse objects. Defaults to false.
+     */
+    itkSetMacro(SparseInitialization, bool);
+    itkGetConstMacro(SparseInitialization, bool);
+    itkBooleanMacro(SparseInitialization);
+
+    /**
+     * @brief Thin the connected components of the object on separate copies,
+     * split across the threads. The copies of the components are thinned 
+     * sequentially : Parallel is not used. The criteria set at run time are 
+     * shared by the components, which are then thinned by a single thread.
+     * Defaults to false.
+     */
+    itkSetMacro(Componentwise, bool);
+    itkGetConstMacro(Componentwise, bool);
+    itkBooleanMacro(Componentwise);
+
+    /**
+     * @name Instrumentation
+     *
+     * When CollectStatistics is set, the wall time of the initialization of 
+     * the queue and of the thinning are measured, and the operations of the 
+     * thinning are counted ; the values are available after Update, summed 
+     * over the components in componentwise mode. Otherwise, the thinning is compiled 
+     * without the instrumentation. Defaults to false.
+     */
+    //@{
+    itkSetMacro(CollectStatistics, bool);
+    itkGetConstMacro(CollectStatistics, bool);
+    itkBooleanMacro(CollectStatistics);
+    
+    itkGetConstMacro(InitializationTime, double);
+    itkGetConstMacro(ThinningTime, double);
+    itkGetConstMacro(NumberOfPops, unsigned long);
+    itkGetConstMacro(NumberOfSimplicityEvaluations, unsigned long);
+    itkGetConstMacro(NumberOfTerminalityEvaluations, unsigned long);
+    itkGetConstMacro(NumberOfDeletions, unsigned long);
+    /** Number of points pushed again after the deletion of a neighbor. */
+    itkGetConstMacro(NumberOfRepushes, unsigned long);
+    /** 
+     * Largest number of points waiting to be evaluated, including in 
+     * parallel mode the points of the level popped from the queue. 
+     */
+    itkGetConstMacro(PeakQueueSize, unsigned long);
+    //@}
+
     /**
      * @name Accessors for the ordering image.
      */
@@ -93,6 +260,18 @@ class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
 
     //@}
     
+    /**
+     * @name Accessors for the distance filter.
+     */
+    //@{
+    typedef ChamferDistanceTransformImageFilter<InputImageType, 
+                                                OrderingImageType> 
+      DistanceFilterType;
+    
+    itkGetObjectMacro(DistanceFilter, DistanceFilterType);
+    itkSetObjectMacro(DistanceFilter, DistanceFilterType);
+    //@}
+    
     /**
      * @name Accessors for the simplicity criterion.
      */
@@ -113,7 +292,13 @@ class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
      * @brief Connectivity used in the foreground of the image.
      */
     typedef TForegroundConnectivity ForegroundConnectivity;
-      
+    
+    /**
+     * @brief Modification time of the filter, including the distance 
+     * filter, which is run by GenerateData instead of the pipeline.
+     */
+    unsigned long GetMTime() const;
+    
   protected :
     SkeletonizeImageFilter();
     SkeletonizeImageFilter(Self const &); // Purposedly not implemented
@@ -123,13 +308,451 @@ class SkeletonizeImageFilter : public InPlaceImageFilter<TImage>
     void GenerateInputRequestedRegion();
     void GenerateData();
     
+    /** @brief Select the criteria, and reset the statistics. */
+    void InitializeCriteria();
+    
+    /** @brief Release the work image from the criteria. */
+    void ReleaseCriteria(OutputImageType * image);
+    
+    /** 
+     * @brief The queue holds offsets in the buffer of the work image, which 
+     * are also the offsets in the work ordering buffer.
+     */
+    typedef HierarchicalQueue<OrderingVoxelType, OffsetValueType, 
+                              std::less<OrderingVoxelType> > QueueType;
+    
+    /**
+     * @brief State of all the points of the work image, packed in a byte.
+     *
+     * A point is a candidate iff it is in the object, not queued and not 
+     * frozen, i.e. on the border of the buffer or with a null priority : the
+     * test of a neighbor is a single load. The object flag is cleared with 
+     * the deletion of the point, along with the output.
+     */
+    class DensePointStates
+      {
+      public :
+        DensePointStates(unsigned long size) : m_States(size, 0) {}
+        
+        enum
+          {
+          Object = 1,
+          Queued = 2,
+          Frozen = 4
+          };
+        
+        bool IsCandidate(OffsetValueType offset) const 
+          { 
+          return m_States[offset] == Object; 
+          }
+        void SetQueued(OffsetValueType offset) { m_States[offset] |= Queued; }
+        void ResetQueued(OffsetValueType offset) 
+          { 
+          m_States[offset] &= ~Queued; 
+          }
+        void Delete(OffsetValueType offset) { m_States[offset] &= ~Object; }
+        
+        void SetState(OffsetValueType offset, unsigned char state)
+          {
+          m_States[offset] = state;
+          }
+      private :
+        std::vector<unsigned char> m_States;
+      };
+    
+    /**
+     * @brief State of the points of the runs of the object.
+     *
+     * The runs only hold the points of the object with a non-null priority,
+     * the points outside of the runs are never candidates. The output tells
+     * if a point of the runs was deleted, i.e. set to the background value.
+     */
+    class SparsePointStates
+      {
+      public :
+        SparsePointStates(InputPixelType const * output, 
+                          InputPixelType backgroundValue)
+        : m_Output(output), m_BackgroundValue(backgroundValue)
+          {
+          }
+        
+        bool IsCandidate(OffsetValueType offset) const 
+          { 
+          return m_Output[offset] != m_BackgroundValue && 
+                 !m_Queued.IsSet(offset);
+          }
+        void SetQueued(OffsetValueType offset) { m_Queued.Set(offset); }
+        void ResetQueued(OffsetValueType offset) { m_Queued.Reset(offset); }
+        void Delete(OffsetValueType) {}
+        
+        RunIndexedBitmap<OutputImageType> & GetQueued() { return m_Queued; }
+      private :
+        InputPixelType const * m_Output;
+        InputPixelType m_BackgroundValue;
+        RunIndexedBitmap<OutputImageType> m_Queued;
+      };
+    
+    /** 
+     * @brief Test if a value is in the object : the foreground value, or any
+     * label in multi-label mode.
+     */
+    bool IsObject(InputPixelType value) const
+      {
+      return m_MultiLabel ? (value != m_BackgroundValue) 
+                          : (value == m_ForegroundValue);
+      }
+    
+    /**
+     * @brief Push the neighbors of a deleted point that are candidates, and 
+     * of the label of the point in multi-label mode. Return the number of 
+     * pushed points.
+     */
+    template<typename TPointStates>
+    unsigned int PushNeighbors(OffsetValueType current, InputPixelType label,
+                               QueueType & q, TPointStates & states);
+    
+    /**
+     * @brief Set the image to thin, i.e. the output or the copy of a 
+     * component, and its ordering buffer.
+     */
+    void SetWorkImage(OutputImageType * image, 
+                      OrderingVoxelType const * ordering);
+    
+    /** 
+     * @brief Queue the points of the object in the work image with a non-null
+     * priority, and thin it.
+     */
+    void ThinWorkImage(ProgressReporter & progress);
+    
+    /**
+     * @brief Queue the points listed by the distance filter, and thin the 
+     * work image.
+     */
+    void ThinListedPoints(ProgressReporter & progress);
+    
+    /**
+     * @name Initialization of the queue
+     *
+     * The dense initialization scans all the points of the image, the sparse
+     * one only flags the points of the runs.
+     */
+    //@{
+    void InitializeQueue(QueueType & q, DensePointStates & states, 
+                         ProgressReporter & progress);
+    void InitializeQueue(QueueType & q, SparsePointStates & states);
+    
+    /** 
+     * @brief Sparse initialization from a list of points in increasing order
+     * of offset.
+     */
+    void InitializeQueue(QueueType & q, SparsePointStates & states, 
+      typename DistanceFilterType::PointListType const & points);
+    //@}
+    
+    /** @brief Thin the initialized queue, collecting the statistics. */
+    template<typename TPointStates>
+    void ThinQueue(QueueType & q, TPointStates & states, 
+                   TimeProbe & initializationProbe, 
+                   ProgressReporter & progress);
+    
+    /**
+     * @name Componentwise mode
+     */
+    //@{
+    /** 
+     * @brief Connected component of the object : its bounding box, and the 
+     * range of its points in the list of the points of all the components.
+     */
+    struct Component
+      {
+      RegionType Region;
+      unsigned long Begin;
+      unsigned long End;
+      };
+    
+    /** @brief Parameters of the threads, and the shared counter. */
+    struct ComponentThreadStruct
+      {
+      Self * Filter;
+      /** @brief Image whose components are thinned in place. */
+      OutputImageType * Image;
+      std::vector<Component> const * Components;
+      /** @brief Offsets of the points of the components in the image. */
+      std::vector<OffsetValueType> const * Points;
+      /** @brief Components by decreasing number of points. */
+      std::vector<unsigned long> const * Order;
+      OrderingVoxelType const * Ordering;
+      std::vector<Pointer> const * Workers;
+      ProgressReporter * Progress;
+      unsigned long Next;
+      SimpleFastMutexLock Lock;
+      };
+    
+    /** 
+     * @brief Thin the components, the ordering buffer having the size of the
+     * output buffer.
+     */
+    void GenerateDataComponentwise(OrderingVoxelType const * ordering,
+                                   ProgressReporter & progress);
+    
+    /** 
+     * @brief Label the connected components of the object in an image with 
+     * the unit cube connectivity.
+     */
+    void LabelComponents(OutputImageType const * image, 
+                         std::vector<Component> & components, 
+                         std::vector<OffsetValueType> & points);
+    
+    static ITK_THREAD_RETURN_TYPE ComponentThreaderCallback(void * arg);
+    
+    /** @brief Region padded by one point, cropped to the bounds. */
+    RegionType PadRegion(RegionType const & region, 
+                         RegionType const & bounds) const;
+    
+    /** @brief Take the components from the counter until none is left. */
+    void ThinComponents(ComponentThreadStruct & str, unsigned int threadId);
+    
+    /** @brief Thin the components taken from the counter by a thread. */
+    void ThinNextComponents(ComponentThreadStruct & str, Self * worker, 
+                            ProgressReporter & progress);
+    
+    /** 
+     * @brief Thin the copy of a component with a worker filter, and paste 
+     * the result back in the image.
+     */
+    void ThinComponent(Component const & component, 
+                       ComponentThreadStruct const & str, Self * worker,
+                       ProgressReporter & progress);
+    //@}
+    
+    /** @brief Tag selecting the instrumented thinning. */
+    template<bool VCollectStatistics>
+    struct CollectStatistics {};
+    
+    /**
+     * @name Criteria of the sequential thinning
+     *
+     * A point can be deleted iff it is simple and not terminal ; both 
+     * criteria are always evaluated.
+     */
+    //@{
+    /** @brief Criteria set at run time, called through BinaryImageFunction.*/
+    struct RuntimeCriteria
+      {
+      Criterion const * Simplicity;
+      Criterion const * Terminality;
+      OutputImageType const * Image;
+      
+      bool IsDeletable(OffsetValueType offset) const
+        {
+        IndexType const index = Image->ComputeIndex(offset);
+        bool const terminal = Terminality->EvaluateAtIndex(index);
+        bool const simple = Simplicity->EvaluateAtIndex(index);
+        return simple && !terminal;
+        }
+      };
+    
+    /** 
+     * @brief Tag selecting the evaluation of both policies on a single 
+     * configuration of the unit cube, up to the dimension 3.
+     */
+    template<bool VUseConfiguration>
+    struct UseConfiguration {};
+    
+    /** 
+     * @brief Default criteria, called directly on the policies. Up to the 
+     * dimension 3, the unit cube around the point is gathered once, by the 
+     * gatherer of the simplicity policy, for both policies.
+     */
+    struct PolicyCriteria
+      {
+      SimplicityPolicyType const * Simplicity;
+      TerminalityPolicyType const * Terminality;
+      NeighborhoodConfigurationType const * Configuration;
+      InputPixelType ForegroundValue;
+      
+      bool IsDeletable(OffsetValueType offset) const
+        {
+        return this->IsDeletable(offset, 
+          UseConfiguration<(InputImageType::ImageDimension <= 3)>());
+        }
+      
+      bool IsDeletable(OffsetValueType offset, UseConfiguration<true>) const
+        {
+        ConfigurationType const configuration = 
+          Configuration->Gather(offset, ForegroundValue);
+        bool const terminal = 
+          Terminality->EvaluateConfiguration(configuration);
+        bool const simple = Simplicity->EvaluateConfiguration(configuration);
+        return simple && !terminal;
+        }
+      
+      bool IsDeletable(OffsetValueType offset, UseConfiguration<false>) const
+        {
+        bool const terminal = Terminality->EvaluateAtOffset(offset);
+        bool const simple = Simplicity->EvaluateAtOffset(offset);
+        return simple && !terminal;
+        }
+      };
+    
+    /** 
+     * @brief Default criteria in multi-label mode, evaluated on the unit 
+     * cube gathered once with the label of the point as foreground.
+     */
+    struct LabelPolicyCriteria
+      {
+      SimplicityPolicyType const * Simplicity;
+      TerminalityPolicyType const * Terminality;
+      NeighborhoodConfigurationType const * Configuration;
+      InputPixelType const * Buffer;
+      
+      bool IsDeletable(OffsetValueType offset) const
+        {
+        ConfigurationType const configuration = 
+          Configuration->Gather(offset, Buffer[offset]);
+        bool const terminal = 
+          Terminality->EvaluateConfiguration(configuration);
+        bool const simple = Simplicity->EvaluateConfiguration(configuration);
+        return simple && !terminal;
+        }
+      };
+    
+    /** 
+     * @brief Criteria in multi-label mode evaluated through 
+     * BinaryImageFunction, their foreground value being set to the label of
+     * the point when it changes.
+     */
+    struct LabelRuntimeCriteria
+      {
+      Criterion * Simplicity;
+      Criterion * Terminality;
+      OutputImageType const * Image;
+      
+      bool IsDeletable(OffsetValueType offset) const
+        {
+        InputPixelType const label = Image->GetBufferPointer()[offset];
+        if(label != Simplicity->GetForegroundValue())
+          {
+          Simplicity->SetForegroundValue(label);
+          Terminality->SetForegroundValue(label);
+          }
+        IndexType const index = Image->ComputeIndex(offset);
+        bool const terminal = Terminality->EvaluateAtIndex(index);
+        bool const simple = Simplicity->EvaluateAtIndex(index);
+        return simple && !terminal;
+        }
+      };
+    //@}
+    
+    /** 
+     * @brief Tag selecting the evaluation of the policies with the label of 
+     * the points, up to the dimension 3.
+     */
+    template<bool VUseLabelPolicies>
+    struct UseLabelPolicies {};
+    
+    /** @brief Thin the labels with the criteria selected at run time. */
+    template<typename TPointStates, bool VCollectStatistics>
+    void ThinLabels(QueueType & q, TPointStates & states, 
+                    ProgressReporter & progress, 
+                    CollectStatistics<VCollectStatistics> collectStatistics,
+                    UseLabelPolicies<true>);
+    template<typename TPointStates, bool VCollectStatistics>
+    void ThinLabels(QueueType & q, TPointStates & states, 
+                    ProgressReporter & progress, 
+                    CollectStatistics<VCollectStatistics> collectStatistics,
+                    UseLabelPolicies<false>);
+    
+    /** @brief Thin the object with the criteria selected at run time. */
+    template<typename TPointStates, bool VCollectStatistics>
+    void Thin(QueueType & q, TPointStates & states, 
+              ProgressReporter & progress, 
+              CollectStatistics<VCollectStatistics> collectStatistics);
+    
+    /** @brief Thin the object until the queue is empty. */
+    template<typename TPointStates, typename TCriteria, 
+             bool VCollectStatistics>
+    void Thin(QueueType & q, TPointStates & states, 
+              TCriteria const & criteria, ProgressReporter & progress, 
+              CollectStatistics<VCollectStatistics>);
+    
+    /**
+     * @name Parallel mode
+     */
+    //@{
+    struct ThinningThreadStruct
+      {
+      Self * Filter;
+      std::vector<OffsetValueType> const * Candidates;
+      std::vector<char> * Deleted;
+      };
+    
+    /** Thinning of one subfield, called by each thread. */
+    static ITK_THREAD_RETURN_TYPE ThinningThreaderCallback(void * arg);
+    
+    /** 
+     * Delete the simple and non-terminal candidates in [begin, end), and flag
+     * them in deleted.
+     */
+    void ThinCandidates(std::vector<OffsetValueType> const & candidates, 
+                        std::vector<char> & deleted,
+                        unsigned long begin, unsigned long end);
+    
+    /** 
+     * @brief Delete the candidates in multi-label mode, evaluating the 
+     * policies with the label of each candidate.
+     */
+    void ThinLabelCandidates(std::vector<OffsetValueType> const & candidates,
+                             std::vector<char> & deleted,
+                             unsigned long begin, unsigned long end, 
+                             UseLabelPolicies<true>);
+    void ThinLabelCandidates(std::vector<OffsetValueType> const & candidates,
+                             std::vector<char> & deleted,
+                             unsigned long begin, unsigned long end, 
+                             UseLabelPolicies<false>);
+    //@}
+    
     typename OrderingImageType::Pointer m_OrderingImage;
+    typename DistanceFilterType::Pointer m_DistanceFilter;
     
     typename BinaryImageFunction<TImage, bool >::Pointer m_SimplicityCriterion;
     typename BinaryImageFunction<TImage, bool >::Pointer m_TerminalityCriterion;
+    
+    typename SimplicityPolicyType::Pointer m_SimplicityPolicy;
+    typename TerminalityPolicyType::Pointer m_TerminalityPolicy;
+    
+    /** 
+     * @brief Criteria of the current update : the criteria set at run time,
+     * or the policies.
+     */
+    Criterion * m_Simplicity;
+    Criterion * m_Terminality;
       
     InputPixelType m_ForegroundValue;
     InputPixelType m_BackgroundValue;
+    
+    bool m_MultiLabel;
+    bool m_Parallel;
+    bool m_SparseInitialization;
+    
+    bool m_Componentwise;
+    
+    /** @brief Image being thinned, and its ordering buffer. */
+    OutputImageType * m_WorkImage;
+    OrderingVoxelType const * m_WorkOrdering;
+    
+    bool m_CollectStatistics;
+    double m_InitializationTime;
+    double m_ThinningTime;
+    unsigned long m_NumberOfPops;
+    unsigned long m_NumberOfSimplicityEvaluations;
+    unsigned long m_NumberOfTerminalityEvaluations;
+    unsigned long m_NumberOfDeletions;
+    unsigned long m_NumberOfRepushes;
+    unsigned long m_PeakQueueSize;
+    
+    /** Offsets of the neighbors in the work image buffer. */
+    std::vector<OffsetValueType> m_NeighborOffsets;
 
   };
 
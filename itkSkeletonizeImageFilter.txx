@@ -1,17 +1,14 @@
 #ifndef itkSkeletonizationImageFilter_txx
 #define itkSkeletonizationImageFilter_txx
 
+#include <algorithm>
 #include <functional>
+#include <utility>
 
+#include <itkImageRegionConstIterator.h>
 #include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
 #include <itkNumericTraits.h>
-#include <itkProgressReporter.h>
-
-#include "itkHierarchicalQueue.h"
-
-#include "itkLineTerminalityImageFunction.h"
-#include "itkSimplicityByTopologicalNumbersImageFunction.h"
-
 
 #include "itkSkeletonizeImageFilter.h"
 
@@ -19,10 +16,13 @@
 namespace itk
 {
 
-template<typename TImage, typename TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
 void
 
-SkeletonizeImageFilter<TImage, TForegroundConnectivity>
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
 
 ::SetOrderingImage(OrderingImageType *input)
 
@@ -36,13 +36,19 @@ SkeletonizeImageFilter<TImage, TForegroundConnectivity>
 
 
 
-template<typename TImage, typename TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
 
 typename 
 
-  SkeletonizeImageFilter<TImage, TForegroundConnectivity>::OrderingImageType * 
+  SkeletonizeImageFilter<TImage, TForegroundConnectivity, 
+
+    TOrderingImage, TSimplicityPolicy, TTerminalityPolicy>
+    ::OrderingImageType * 
 
-SkeletonizeImageFilter<TImage, TForegroundConnectivity>
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
 
 ::GetOrderingImage()
 
@@ -56,21 +62,48 @@ SkeletonizeImageFilter<TImage, TForegroundConnectivity>
 
   }
 
-template<typename TImage, typename TForegroundConnectivity>
-SkeletonizeImageFilter<TImage, TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
 ::SkeletonizeImageFilter()
-: m_SimplicityCriterion(0),
+: m_DistanceFilter(0),
+  m_SimplicityCriterion(0),
   m_TerminalityCriterion(0)
   {
-  this->SetNumberOfRequiredInputs(2);
+  // The ordering image is optional when a distance filter is set
+  this->SetNumberOfRequiredInputs(1);
   m_ForegroundValue = NumericTraits<InputPixelType>::max();
   m_BackgroundValue = NumericTraits<InputPixelType>::Zero;
+  m_MultiLabel = false;
+  m_Parallel = false;
+  m_SparseInitialization = false;
+  m_Componentwise = false;
+  m_SimplicityPolicy = SimplicityPolicyType::New();
+  m_TerminalityPolicy = TerminalityPolicyType::New();
+  m_Simplicity = 0;
+  m_Terminality = 0;
+  m_WorkImage = 0;
+  m_WorkOrdering = 0;
+  m_CollectStatistics = false;
+  m_InitializationTime = 0;
+  m_ThinningTime = 0;
+  m_NumberOfPops = 0;
+  m_NumberOfSimplicityEvaluations = 0;
+  m_NumberOfTerminalityEvaluations = 0;
+  m_NumberOfDeletions = 0;
+  m_NumberOfRepushes = 0;
+  m_PeakQueueSize = 0;
   }
 
 
-template<typename TImage, typename TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
 void 
-SkeletonizeImageFilter<TImage, TForegroundConnectivity>
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
 ::PrintSelf(std::ostream& os, Indent indent) const
   {
   Superclass::PrintSelf(os,indent);
@@ -81,14 +114,40 @@ SkeletonizeImageFilter<TImage, TForegroundConnectivity>
      <<  ForegroundConnectivity::CellDimension << std::endl;
     os << indent << "ForegroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_ForegroundValue) << std::endl;
     os << indent << "BackgroundValue: " << static_cast<typename NumericTraits<InputPixelType>::PrintType>(m_BackgroundValue) << std::endl;
+    os << indent << "DistanceFilter: " << m_DistanceFilter.GetPointer() 
+       << std::endl;
+    os << indent << "MultiLabel: " << m_MultiLabel << std::endl;
+    os << indent << "Parallel: " << m_Parallel << std::endl;
+    os << indent << "SparseInitialization: " << m_SparseInitialization 
+       << std::endl;
+    os << indent << "Componentwise: " << m_Componentwise << std::endl;
+    os << indent << "CollectStatistics: " << m_CollectStatistics << std::endl;
+    if(m_CollectStatistics)
+      {
+      os << indent << "InitializationTime: " << m_InitializationTime 
+         << std::endl;
+      os << indent << "ThinningTime: " << m_ThinningTime << std::endl;
+      os << indent << "NumberOfPops: " << m_NumberOfPops << std::endl;
+      os << indent << "NumberOfSimplicityEvaluations: " 
+         << m_NumberOfSimplicityEvaluations << std::endl;
+      os << indent << "NumberOfTerminalityEvaluations: " 
+         << m_NumberOfTerminalityEvaluations << std::endl;
+      os << indent << "NumberOfDeletions: " << m_NumberOfDeletions 
+         << std::endl;
+      os << indent << "NumberOfRepushes: " << m_NumberOfRepushes << std::endl;
+      os << indent << "PeakQueueSize: " << m_PeakQueueSize << std::endl;
+      }
   }
 
 
-template<typename TImage, typename TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
 
 void 
 
-SkeletonizeImageFilter<TImage, TForegroundConnectivity>
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
 
 ::GenerateInputRequestedRegion()
 
@@ -110,7 +169,7 @@ SkeletonizeImageFilter<TImage, TForegroundConnectivity>
 
 
 
-  if ( !orderingPtr || !inputPtr )
+  if ( !inputPtr )
 
     { 
 
@@ -123,139 +182,1251 @@ SkeletonizeImageFilter<TImage, TForegroundConnectivity>
   // We need to
 
   // configure the inputs such that all the data is available.
-
   //
-
-  orderingPtr->SetRequestedRegion(orderingPtr->GetLargestPossibleRegion());
-
   inputPtr->SetRequestedRegion(inputPtr->GetLargestPossibleRegion());
+  if(orderingPtr)
+    {
+    // Otherwise the distance filter computes the ordering from the input
+    orderingPtr->SetRequestedRegion(orderingPtr->GetLargestPossibleRegion());
+    }
 
   }
 
 
 
-template<typename TImage, typename TForegroundConnectivity>
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+unsigned long 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::GetMTime() const
+  {
+  unsigned long mtime = Superclass::GetMTime();
+  if(m_DistanceFilter.IsNotNull())
+    {
+    mtime = std::max(mtime, m_DistanceFilter->GetMTime());
+    }
+  return mtime;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
 void 
-SkeletonizeImageFilter<TImage, TForegroundConnectivity>
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
 ::GenerateData()
   {
+  typename OrderingImageType::Pointer orderingImage = this->GetOrderingImage();
+  if(m_MultiLabel && m_Parallel && 
+     (InputImageType::ImageDimension > 3 || 
+      m_SimplicityCriterion.IsNotNull() || 
+      m_TerminalityCriterion.IsNotNull()))
+    {
+    itkExceptionMacro(<< "The parallel multi-label mode requires the default "
+                      << "criteria, up to the dimension 3");
+    }
+  if(orderingImage.IsNull())
+    {
+    if(m_DistanceFilter.IsNull())
+      {
+      itkExceptionMacro(<< "An ordering image or a distance filter is "
+                        << "required");
+      }
+    if(m_DistanceFilter->GetDistanceFromObject())
+      {
+      itkExceptionMacro(<< "The distance filter must compute the distance "
+                        << "in the object");
+      }
+    
+    // Compute the ordering before the output takes over the input buffer, 
+    // listing the points of the object on the way, unless the components 
+    // are labeled.
+    m_DistanceFilter->SetInput(this->GetInput());
+    m_DistanceFilter->SetMultiLabel(m_MultiLabel);
+    m_DistanceFilter->SetBackgroundValue(m_BackgroundValue);
+    m_DistanceFilter->SetListNonNullPoints(!m_Componentwise);
+    m_DistanceFilter->Update();
+    }
+  
   this->AllocateOutputs();
   
-  typename OrderingImageType::Pointer orderingImage = this->GetOrderingImage();
+  this->InitializeCriteria();
   
-  if(m_SimplicityCriterion.IsNull())
+  typename OutputImageType::Pointer outputImage = this->GetOutput(0);
+  
+  // set up progress reporter. There is 2 steps, but we can't know how many 
+  // pixels will be in the second one, so use the maximum
+  ProgressReporter 
+    progress(this, 0, outputImage->GetRequestedRegion().GetNumberOfPixels()*2);
+  
+  if(orderingImage.IsNull())
     {
-    m_SimplicityCriterion = 
+    // The distance map starts at the origin of the index space, only the 
+    // sizes of the buffers must match.
+    OrderingImageType * const distance = m_DistanceFilter->GetOutput();
+    if(distance->GetBufferedRegion().GetSize() != 
+       outputImage->GetBufferedRegion().GetSize())
+      {
+      itkExceptionMacro(<< "Distance map buffered region "
+                        << distance->GetBufferedRegion()
+                        << " differs from output buffered region "
+                        << outputImage->GetBufferedRegion());
+      }
+    
+    if(m_Componentwise)
+      {
+      this->GenerateDataComponentwise(distance->GetBufferPointer(), progress);
+      }
+    else
+      {
+      this->SetWorkImage(outputImage, distance->GetBufferPointer());
+      this->ThinListedPoints(progress);
+      }
+    distance->ReleaseData();
+    }
+  else
+    {
+    // The main loop works on linear offsets, shared by the output and 
+    // ordering buffers.
+    if(orderingImage->GetBufferedRegion() != 
+       outputImage->GetBufferedRegion())
+      {
+      itkExceptionMacro(<< "Ordering image buffered region "
+                        << orderingImage->GetBufferedRegion()
+                        << " differs from output buffered region "
+                        << outputImage->GetBufferedRegion());
+      }
+    
+    if(m_Componentwise)
+      {
+      this->GenerateDataComponentwise(orderingImage->GetBufferPointer(), 
+                                      progress);
+      }
+    else
+      {
+      this->SetWorkImage(outputImage, orderingImage->GetBufferPointer());
+      this->ThinWorkImage(progress);
+      }
+    }
+  
+  this->ReleaseCriteria(this->GetOutput(0));
+  }
 
-      SimplicityByTopologicalNumbersImageFunction<OutputImageType, 
 
-        TForegroundConnectivity>::New();
-    }
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::InitializeCriteria()
+  {
+  m_Simplicity = m_SimplicityCriterion.IsNull() ? 
+    static_cast<Criterion *>(m_SimplicityPolicy.GetPointer()) : 
+    m_SimplicityCriterion.GetPointer();
+  m_Simplicity->SetForegroundValue( m_ForegroundValue );
   
-  m_SimplicityCriterion->SetInputImage(this->GetInput());
-  m_SimplicityCriterion->SetForegroundValue( m_ForegroundValue );
+  m_Terminality = m_TerminalityCriterion.IsNull() ? 
+    static_cast<Criterion *>(m_TerminalityPolicy.GetPointer()) : 
+    m_TerminalityCriterion.GetPointer();
+  m_Terminality->SetForegroundValue( m_ForegroundValue );
   
-  if(m_TerminalityCriterion.IsNull())
+  m_InitializationTime = 0;
+  m_ThinningTime = 0;
+  m_NumberOfPops = 0;
+  m_NumberOfSimplicityEvaluations = 0;
+  m_NumberOfTerminalityEvaluations = 0;
+  m_NumberOfDeletions = 0;
+  m_NumberOfRepushes = 0;
+  m_PeakQueueSize = 0;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ReleaseCriteria(OutputImageType * image)
+  {
+  // The criteria must not keep the copy of a component alive
+  m_Simplicity->SetInputImage(image);
+  m_Terminality->SetInputImage(image);
+  m_Simplicity = 0;
+  m_Terminality = 0;
+  m_WorkImage = 0;
+  m_WorkOrdering = 0;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::SetWorkImage(OutputImageType * image, OrderingVoxelType const * ordering)
+  {
+  m_WorkImage = image;
+  m_WorkOrdering = ordering;
+  
+  m_Simplicity->SetInputImage(image);
+  m_Terminality->SetInputImage(image);
+  
+  ForegroundConnectivity const & connectivity = 
+    ForegroundConnectivity::GetInstance();
+  m_NeighborOffsets.resize(connectivity.GetNumberOfNeighbors());
+  for(unsigned int i = 0; i < connectivity.GetNumberOfNeighbors(); ++i)
     {
-    m_TerminalityCriterion = 
+    OffsetType neighbor;
+    for(unsigned int j = 0; j < ForegroundConnectivity::Dimension; ++j)
+      {
+      neighbor[j] = connectivity.GetNeighborsPoints()[i][j];
+      }
+    m_NeighborOffsets[i] = image->ComputeOffset(
+      image->GetBufferedRegion().GetIndex() + neighbor);
+    }
+  }
 
-      LineTerminalityImageFunction<OutputImageType, 
 
-        TForegroundConnectivity>::New();
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinWorkImage(ProgressReporter & progress)
+  {
+  TimeProbe initializationProbe;
+  if(m_CollectStatistics)
+    {
+    initializationProbe.Start();
     }
   
-  m_TerminalityCriterion->SetInputImage(this->GetInput());
-  m_TerminalityCriterion->SetForegroundValue( m_ForegroundValue );
+  QueueType q;
+  if(m_SparseInitialization)
+    {
+    SparsePointStates states(m_WorkImage->GetBufferPointer(), 
+                             m_BackgroundValue);
+    this->InitializeQueue(q, states);
+    this->ThinQueue(q, states, initializationProbe, progress);
+    }
+  else
+    {
+    DensePointStates states(
+      m_WorkImage->GetBufferedRegion().GetNumberOfPixels());
+    this->InitializeQueue(q, states, progress);
+    this->ThinQueue(q, states, initializationProbe, progress);
+    }
+  }
 
-  typename OutputImageType::Pointer outputImage = this->GetOutput(0);
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinListedPoints(ProgressReporter & progress)
+  {
+  TimeProbe initializationProbe;
+  if(m_CollectStatistics)
+    {
+    initializationProbe.Start();
+    }
+  
+  QueueType q;
+  SparsePointStates states(m_WorkImage->GetBufferPointer(), 
+                           m_BackgroundValue);
+  this->InitializeQueue(q, states, m_DistanceFilter->GetNonNullPoints());
+  m_DistanceFilter->ReleaseNonNullPoints();
+  this->ThinQueue(q, states, initializationProbe, progress);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::InitializeQueue(QueueType & q, DensePointStates & states, 
+                  ProgressReporter & progress)
+  {
+  RegionType const & region = m_WorkImage->GetBufferedRegion();
+  InputPixelType const * const outputBuffer = m_WorkImage->GetBufferPointer();
+  
+  // The points on the border of the buffer are frozen, so that they are 
+  // never queued : the neighbors of a queued point are thus always in the 
+  // buffer, and no bound check is needed.
+  IndexType const firstIndex = region.GetIndex();
+  IndexType lastIndex = firstIndex;
+  for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+    {
+    lastIndex[j] += region.GetSize()[j] - 1;
+    }
   
-  // Initialize hierarchical queue
-  HierarchicalQueue<typename OrderingImageType::PixelType, 
-                     typename InputImageType::IndexType, 
-                     std::less<typename OrderingImageType::PixelType> > q;
+  OffsetValueType offset = 0;
+  for(ImageRegionConstIteratorWithIndex<OutputImageType> 
+        it(m_WorkImage, region);
+      !it.IsAtEnd(); ++it, ++offset)
+    {
+    bool border = false;
+    for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+      {
+      if(it.GetIndex()[j] == firstIndex[j] || it.GetIndex()[j] == lastIndex[j])
+        {
+        border = true;
+        }
+      }
+    
+    unsigned char state = 
+      this->IsObject(outputBuffer[offset]) ? DensePointStates::Object : 0;
+    if(border || 
+       m_WorkOrdering[offset] == NumericTraits<OrderingVoxelType>::Zero)
+      {
+      state |= DensePointStates::Frozen;
+      }
+    else if(state == DensePointStates::Object)
+      {
+      q.Push(m_WorkOrdering[offset], offset);
+      state |= DensePointStates::Queued;
+      }
+    states.SetState(offset, state);
+    progress.CompletedPixel();
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::InitializeQueue(QueueType & q, SparsePointStates & states)
+  {
+  RunIndexedBitmap<OutputImageType> & inQueue = states.GetQueued();
+  SizeType const & size = m_WorkImage->GetBufferedRegion().GetSize();
+  InputPixelType const * const outputBuffer = m_WorkImage->GetBufferPointer();
+  long const width = size[0];
+  
+  inQueue.Initialize(size);
+  
+  // Scan the lines of the buffer that are not on its border, and extract the
+  // runs of the object with a non-null priority, the first and last points 
+  // of the lines being skipped. The points outside of the runs are never 
+  // queued.
+  IndexType line;
+  line.Fill(1);
+  line[0] = 0;
+  bool hasInterior = (width > 2);
+  for(unsigned int j = 1; j < InputImageType::ImageDimension; ++j)
+    {
+    hasInterior = hasInterior && (size[j] > 2);
+    }
+  while(hasInterior)
+    {
+    OffsetValueType lineOffset = 0;
+    OffsetValueType stride = width;
+    for(unsigned int j = 1; j < InputImageType::ImageDimension; ++j)
+      {
+      lineOffset += line[j]*stride;
+      stride *= size[j];
+      }
+    
+    OffsetValueType runBegin = -1;
+    for(OffsetValueType offset = lineOffset+1; 
+        offset < lineOffset+width-1; ++offset)
+      {
+      bool const active = 
+        this->IsObject(outputBuffer[offset]) && 
+        m_WorkOrdering[offset] != NumericTraits<OrderingVoxelType>::Zero;
+      if(active)
+        {
+        q.Push(m_WorkOrdering[offset], offset);
+        if(runBegin < 0)
+          {
+          runBegin = offset;
+          }
+        }
+      else if(runBegin >= 0)
+        {
+        inQueue.AddRun(runBegin, offset);
+        runBegin = -1;
+        }
+      }
+    if(runBegin >= 0)
+      {
+      inQueue.AddRun(runBegin, lineOffset+width-1);
+      }
+    
+    // Next line inside the border
+    unsigned int j = 1;
+    while(j < InputImageType::ImageDimension && 
+          line[j] == long(size[j])-2)
+      {
+      line[j] = 1;
+      ++j;
+      }
+    if(j == InputImageType::ImageDimension)
+      {
+      break;
+      }
+    ++line[j];
+    }
   
-  bool* inQueue = 
+  inQueue.Finalize();
+  }
 
-    new bool[outputImage->GetRequestedRegion().GetNumberOfPixels()];
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::InitializeQueue(QueueType & q, SparsePointStates & states, 
+                  typename DistanceFilterType::PointListType const & points)
+  {
+  RunIndexedBitmap<OutputImageType> & inQueue = states.GetQueued();
+  SizeType const & size = m_WorkImage->GetBufferedRegion().GetSize();
+  InputPixelType const * const outputBuffer = m_WorkImage->GetBufferPointer();
   
-  // set up progress reporter. There is 2 steps, but we can't know how many 
+  inQueue.Initialize(size);
+  
+  // The points are queued in the same order as the scan of the sparse 
+  // initialization, the points on the border being skipped ; the runs are 
+  // the sequences of consecutive offsets, which never cross the border.
+  OffsetValueType runBegin = -1;
+  OffsetValueType runEnd = -1;
+  for(typename DistanceFilterType::PointListType::const_iterator 
+        it = points.begin(); it != points.end(); ++it)
+    {
+    OffsetValueType const offset = *it;
+    if(!this->IsObject(outputBuffer[offset]))
+      {
+      continue;
+      }
+    
+    bool border = false;
+    OffsetValueType remainder = offset;
+    for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+      {
+      OffsetValueType const coordinate = remainder % long(size[j]);
+      remainder /= long(size[j]);
+      if(coordinate == 0 || coordinate == long(size[j])-1)
+        {
+        border = true;
+        }
+      }
+    if(border)
+      {
+      continue;
+      }
+    
+    q.Push(m_WorkOrdering[offset], offset);
+    if(offset != runEnd)
+      {
+      if(runBegin >= 0)
+        {
+        inQueue.AddRun(runBegin, runEnd);
+        }
+      runBegin = offset;
+      }
+    runEnd = offset+1;
+    }
+  if(runBegin >= 0)
+    {
+    inQueue.AddRun(runBegin, runEnd);
+    }
+  
+  inQueue.Finalize();
+  }
 
-  // pixels will be in the second one, so use the maximum
 
-  ProgressReporter 
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+template<typename TPointStates>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinQueue(QueueType & q, TPointStates & states, 
+            TimeProbe & initializationProbe, ProgressReporter & progress)
+  {
+  if(m_CollectStatistics)
+    {
+    initializationProbe.Stop();
+    m_InitializationTime += initializationProbe.GetMeanTime();
+    m_PeakQueueSize = std::max(m_PeakQueueSize, q.Size());
+    
+    TimeProbe thinningProbe;
+    thinningProbe.Start();
+    this->Thin(q, states, progress, CollectStatistics<true>());
+    thinningProbe.Stop();
+    m_ThinningTime += thinningProbe.GetMeanTime();
+    }
+  else
+    {
+    this->Thin(q, states, progress, CollectStatistics<false>());
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+typename SkeletonizeImageFilter<TImage, TForegroundConnectivity, 
+                                TOrderingImage, TSimplicityPolicy, 
+                                TTerminalityPolicy>::RegionType
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::PadRegion(RegionType const & region, RegionType const & bounds) const
+  {
+  RegionType padded = region;
+  padded.PadByRadius(1);
+  padded.Crop(bounds);
+  return padded;
+  }
 
-    progress(this, 0, outputImage->GetRequestedRegion().GetNumberOfPixels()*2);
-  for(ImageRegionConstIteratorWithIndex<OrderingImageType> 
 
-        it(orderingImage, orderingImage->GetRequestedRegion());
-      !it.IsAtEnd(); ++it)
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::GenerateDataComponentwise(OrderingVoxelType const * ordering, 
+                            ProgressReporter & progress)
+  {
+  TimeProbe labelingProbe;
+  if(m_CollectStatistics)
+    {
+    labelingProbe.Start();
+    }
+  
+  std::vector<Component> components;
+  std::vector<OffsetValueType> points;
+  OutputImageType * const outputImage = this->GetOutput(0);
+  this->LabelComponents(outputImage, components, points);
+  
+  // The largest components are taken first, so that the last ones to finish
+  // are small.
+  std::vector<std::pair<unsigned long, unsigned long> > sizes;
+  sizes.reserve(components.size());
+  for(unsigned long i = 0; i < components.size(); ++i)
+    {
+    sizes.push_back(std::make_pair(components[i].End-components[i].Begin, i));
+    }
+  std::stable_sort(sizes.begin(), sizes.end(), 
+    std::greater<std::pair<unsigned long, unsigned long> >());
+  std::vector<unsigned long> order(sizes.size());
+  for(unsigned long i = 0; i < sizes.size(); ++i)
+    {
+    order[i] = sizes[i].second;
+    }
+  
+  if(m_CollectStatistics)
+    {
+    labelingProbe.Stop();
+    m_InitializationTime += labelingProbe.GetMeanTime();
+    }
+  if(components.empty())
     {
-    if(it.Get() != NumericTraits<typename OrderingImageType::PixelType>::Zero )
+    return;
+    }
+  
+  // The criteria set at run time are shared, and evaluated by one thread.
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
+  if(m_SimplicityCriterion.IsNotNull() || m_TerminalityCriterion.IsNotNull())
+    {
+    numberOfThreads = 1;
+    }
+  numberOfThreads = std::min<unsigned long>(numberOfThreads, 
+                                            components.size());
+  
+  // Each thread thins its components with a worker filter holding its own 
+  // policies and work image ; the workers are created before the threads.
+  std::vector<Pointer> workers(numberOfThreads);
+  for(unsigned int i = 0; i < numberOfThreads; ++i)
+    {
+    Pointer worker = Self::New();
+    worker->m_ForegroundValue = m_ForegroundValue;
+    worker->m_BackgroundValue = m_BackgroundValue;
+    worker->m_MultiLabel = m_MultiLabel;
+    worker->m_SparseInitialization = m_SparseInitialization;
+    worker->m_CollectStatistics = m_CollectStatistics;
+    worker->m_SimplicityCriterion = m_SimplicityCriterion;
+    worker->m_TerminalityCriterion = m_TerminalityCriterion;
+    worker->m_Simplicity = m_SimplicityCriterion.IsNull() ? 
+      static_cast<Criterion *>(worker->m_SimplicityPolicy.GetPointer()) : 
+      m_SimplicityCriterion.GetPointer();
+    worker->m_Simplicity->SetForegroundValue(m_ForegroundValue);
+    worker->m_Terminality = m_TerminalityCriterion.IsNull() ? 
+      static_cast<Criterion *>(worker->m_TerminalityPolicy.GetPointer()) : 
+      m_TerminalityCriterion.GetPointer();
+    worker->m_Terminality->SetForegroundValue(m_ForegroundValue);
+    workers[i] = worker;
+    }
+  
+  ComponentThreadStruct str;
+  str.Filter = this;
+  str.Image = outputImage;
+  str.Components = &components;
+  str.Points = &points;
+  str.Order = &order;
+  str.Ordering = ordering;
+  str.Workers = &workers;
+  str.Progress = &progress;
+  str.Next = 0;
+  
+  this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+  this->GetMultiThreader()->SetSingleMethod(
+    this->ComponentThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::LabelComponents(OutputImageType const * image, 
+                  std::vector<Component> & components, 
+                  std::vector<OffsetValueType> & points)
+  {
+  RegionType const & region = image->GetBufferedRegion();
+  InputPixelType const * const buffer = image->GetBufferPointer();
+  
+  typedef Connectivity<InputImageType::ImageDimension, 0> 
+    UnitCubeConnectivity;
+  UnitCubeConnectivity const & unitCube = UnitCubeConnectivity::GetInstance();
+  std::vector<OffsetType> neighbors(unitCube.GetNumberOfNeighbors());
+  std::vector<OffsetValueType> neighborOffsets(neighbors.size());
+  for(unsigned int i = 0; i < neighbors.size(); ++i)
+    {
+    for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
       {
-      q.Push(it.Get(), it.GetIndex());
-      inQueue[ outputImage->ComputeOffset(it.GetIndex()) ] = true;
+      neighbors[i][j] = unitCube.GetNeighborsPoints()[i][j];
+      }
+    neighborOffsets[i] = 
+      image->ComputeOffset(region.GetIndex() + neighbors[i]);
     }
-    else
+  
+  // Depth-first fill of each component from its first point in raster 
+  // order. Only the points on the border of the buffer check 
+  // that their neighbors are inside.
+  std::vector<bool> visited(region.GetNumberOfPixels(), false);
+  std::vector<OffsetValueType> stack;
+  for(ImageRegionConstIteratorWithIndex<OutputImageType> seedIt(image, region);
+      !seedIt.IsAtEnd(); ++seedIt)
+    {
+    OffsetValueType const seed = image->ComputeOffset(seedIt.GetIndex());
+    if(visited[seed] || !this->IsObject(buffer[seed]))
       {
-      inQueue[ outputImage->ComputeOffset(it.GetIndex()) ] = false;
+      continue;
       }
-    progress.CompletedPixel();
+    
+    Component component;
+    component.Begin = points.size();
+    IndexType minimum = image->ComputeIndex(seed);
+    IndexType maximum = minimum;
+    visited[seed] = true;
+    stack.push_back(seed);
+    while(!stack.empty())
+      {
+      OffsetValueType const current = stack.back();
+      stack.pop_back();
+      points.push_back(current);
+      
+      IndexType const index = image->ComputeIndex(current);
+      bool onBorder = false;
+      for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+        {
+        minimum[j] = std::min(minimum[j], index[j]);
+        maximum[j] = std::max(maximum[j], index[j]);
+        long const first = region.GetIndex()[j];
+        long const last = first + static_cast<long>(region.GetSize()[j]) - 1;
+        if(index[j] == first || index[j] == last)
+          {
+          onBorder = true;
+          }
+        }
+      
+      for(unsigned int i = 0; i < neighbors.size(); ++i)
+        {
+        if(onBorder && !region.IsInside(index + neighbors[i]))
+          {
+          continue;
+          }
+        OffsetValueType const neighbor = current + neighborOffsets[i];
+        if(!visited[neighbor] && this->IsObject(buffer[neighbor]))
+          {
+          visited[neighbor] = true;
+          stack.push_back(neighbor);
+          }
+        }
+      }
+    component.End = points.size();
+    
+    SizeType componentSize;
+    for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+      {
+      componentSize[j] = maximum[j] - minimum[j] + 1;
+      }
+    component.Region.SetIndex(minimum);
+    component.Region.SetSize(componentSize);
+    components.push_back(component);
     }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+ITK_THREAD_RETURN_TYPE
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ComponentThreaderCallback(void * arg)
+  {
+  MultiThreader::ThreadInfoStruct * info = 
+    static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  ComponentThreadStruct * str = 
+    static_cast<ComponentThreadStruct *>(info->UserData);
   
-  ForegroundConnectivity const & connectivity = 
+  str->Filter->ThinComponents(*str, info->ThreadID);
+  
+  return ITK_THREAD_RETURN_VALUE;
+  }
 
-    ForegroundConnectivity::GetInstance();
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinComponents(ComponentThreadStruct & str, unsigned int threadId)
+  {
+  Self * const worker = (*str.Workers)[threadId];
   
-  while(!q.IsEmpty())
+  // Only the first thread reports the progress : the other threads get a
+  // reporter of their own, which is not built for the first one.
+  if(threadId == 0)
+    {
+    this->ThinNextComponents(str, worker, *str.Progress);
+    }
+  else
     {
-    typename InputImageType::IndexType const current = q.GetFront();
-    q.Pop();
-    inQueue[outputImage->ComputeOffset(current)] = false;
+    ProgressReporter threadProgress(this, threadId, 1);
+    this->ThinNextComponents(str, worker, threadProgress);
+    }
+  
+  if(m_CollectStatistics)
+    {
+    str.Lock.Lock();
+    m_InitializationTime += worker->m_InitializationTime;
+    m_ThinningTime += worker->m_ThinningTime;
+    m_NumberOfPops += worker->m_NumberOfPops;
+    m_NumberOfSimplicityEvaluations += 
+      worker->m_NumberOfSimplicityEvaluations;
+    m_NumberOfTerminalityEvaluations += 
+      worker->m_NumberOfTerminalityEvaluations;
+    m_NumberOfDeletions += worker->m_NumberOfDeletions;
+    m_NumberOfRepushes += worker->m_NumberOfRepushes;
+    m_PeakQueueSize = std::max(m_PeakQueueSize, worker->m_PeakQueueSize);
+    str.Lock.Unlock();
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinNextComponents(ComponentThreadStruct & str, Self * worker, 
+                     ProgressReporter & progress)
+  {
+  for(;;)
+    {
+    str.Lock.Lock();
+    unsigned long const next = str.Next;
+    if(next < str.Order->size())
+      {
+      ++str.Next;
+      }
+    str.Lock.Unlock();
+    if(next >= str.Order->size())
+      {
+      break;
+      }
     
-    bool const terminal = m_TerminalityCriterion->EvaluateAtIndex(current);
-    bool const simple = m_SimplicityCriterion->EvaluateAtIndex(current);
+    this->ThinComponent((*str.Components)[(*str.Order)[next]], str, worker,
+                        progress);
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinComponent(Component const & component, 
+                ComponentThreadStruct const & str, Self * worker, 
+                ProgressReporter & progress)
+  {
+  OutputImageType * const outputImage = str.Image;
+  InputPixelType * const output = outputImage->GetBufferPointer();
+  RegionType const padded = 
+    this->PadRegion(component.Region, outputImage->GetBufferedRegion());
+  
+  // Copy the points of the component only : the bounding box may hold points
+  // of other components, which are left in the background. The points of 
+  // the padding are on the border of the copy and are never removed.
+  typename OutputImageType::Pointer image = OutputImageType::New();
+  image->SetRegions(padded);
+  image->Allocate();
+  image->FillBuffer(m_BackgroundValue);
+  InputPixelType * const copy = image->GetBufferPointer();
+  std::vector<OrderingVoxelType> ordering(
+    padded.GetNumberOfPixels(), NumericTraits<OrderingVoxelType>::Zero);
+  
+  std::vector<OffsetValueType> const & points = *str.Points;
+  for(unsigned long i = component.Begin; i < component.End; ++i)
+    {
+    OffsetValueType const offset = 
+      image->ComputeOffset(outputImage->ComputeIndex(points[i]));
+    copy[offset] = output[points[i]];
+    ordering[offset] = str.Ordering[points[i]];
+    }
+  
+  worker->SetWorkImage(image, &ordering[0]);
+  worker->ThinWorkImage(progress);
+  
+  // The components are disjoint, so the threads write different points
+  for(unsigned long i = component.Begin; i < component.End; ++i)
+    {
+    output[points[i]] = 
+      copy[image->ComputeOffset(outputImage->ComputeIndex(points[i]))];
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+template<typename TPointStates, bool VCollectStatistics>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::Thin(QueueType & q, TPointStates & states, ProgressReporter & progress, 
+       CollectStatistics<VCollectStatistics> collectStatistics)
+  {
+  if(m_MultiLabel)
+    {
+    this->ThinLabels(q, states, progress, collectStatistics, 
+      UseLabelPolicies<(InputImageType::ImageDimension <= 3)>());
+    }
+  else if(m_SimplicityCriterion.IsNull() && m_TerminalityCriterion.IsNull())
+    {
+    PolicyCriteria criteria;
+    criteria.Simplicity = m_SimplicityPolicy;
+    criteria.Terminality = m_TerminalityPolicy;
+    criteria.Configuration = 
+      &m_SimplicityPolicy->GetNeighborhoodConfiguration();
+    criteria.ForegroundValue = m_ForegroundValue;
+    this->Thin(q, states, criteria, progress, collectStatistics);
+    }
+  else
+    {
+    RuntimeCriteria criteria;
+    criteria.Simplicity = m_Simplicity;
+    criteria.Terminality = m_Terminality;
+    criteria.Image = m_WorkImage;
+    this->Thin(q, states, criteria, progress, collectStatistics);
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+template<typename TPointStates, bool VCollectStatistics>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinLabels(QueueType & q, TPointStates & states, 
+             ProgressReporter & progress, 
+             CollectStatistics<VCollectStatistics> collectStatistics, 
+             UseLabelPolicies<true>)
+  {
+  if(m_SimplicityCriterion.IsNull() && m_TerminalityCriterion.IsNull())
+    {
+    LabelPolicyCriteria criteria;
+    criteria.Simplicity = m_SimplicityPolicy;
+    criteria.Terminality = m_TerminalityPolicy;
+    criteria.Configuration = 
+      &m_SimplicityPolicy->GetNeighborhoodConfiguration();
+    criteria.Buffer = m_WorkImage->GetBufferPointer();
+    this->Thin(q, states, criteria, progress, collectStatistics);
+    }
+  else
+    {
+    this->ThinLabels(q, states, progress, collectStatistics, 
+                     UseLabelPolicies<false>());
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+template<typename TPointStates, bool VCollectStatistics>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinLabels(QueueType & q, TPointStates & states, 
+             ProgressReporter & progress, 
+             CollectStatistics<VCollectStatistics> collectStatistics, 
+             UseLabelPolicies<false>)
+  {
+  LabelRuntimeCriteria criteria;
+  criteria.Simplicity = m_Simplicity;
+  criteria.Terminality = m_Terminality;
+  criteria.Image = m_WorkImage;
+  this->Thin(q, states, criteria, progress, collectStatistics);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+template<typename TPointStates, typename TCriteria, bool VCollectStatistics>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::Thin(QueueType & q, TPointStates & states, TCriteria const & criteria, 
+       ProgressReporter & progress, CollectStatistics<VCollectStatistics>)
+  {
+  // The counters are kept locally, and are optimized away when the 
+  // statistics are not collected.
+  unsigned long numberOfPops = 0;
+  unsigned long numberOfDeletions = 0;
+  unsigned long numberOfRepushes = 0;
+  unsigned long peakQueueSize = q.Size();
+  
+  OutputImageType * const outputImage = m_WorkImage;
+  InputPixelType * const outputBuffer = outputImage->GetBufferPointer();
+  
+  if(!m_Parallel)
+    {
+    while(!q.Empty())
+      {
+      OffsetValueType const current = q.FrontValue();
+      q.Pop();
+      states.ResetQueued(current);
+      
+      bool const deletable = criteria.IsDeletable(current);
+      
+      if(VCollectStatistics)
+        {
+        ++numberOfPops;
+        }
+      
+      if( deletable )
+        {
+        InputPixelType const label = outputBuffer[current];
+        outputBuffer[current] = m_BackgroundValue;
+        states.Delete(current);
+        unsigned int const pushed = 
+          this->PushNeighbors(current, label, q, states);
+        if(VCollectStatistics)
+          {
+          ++numberOfDeletions;
+          numberOfRepushes += pushed;
+          peakQueueSize = std::max(peakQueueSize, q.Size());
+          }
+        }
+      progress.CompletedPixel();
+      }
+    }
+  else
+    {
+    unsigned int const numberOfSubfields = 1 << InputImageType::ImageDimension;
+    std::vector<std::vector<OffsetValueType> > subfields(numberOfSubfields);
+    std::vector<char> deleted;
+    std::vector<InputPixelType> labels;
+    // Points popped from the queue whose subfield is not processed yet
+    unsigned long pendingCandidates = 0;
     
-    if( simple && !terminal )
+    while(!q.Empty())
       {
-      outputImage->SetPixel(current, 
+      // Pop the whole level, the points stay flagged as queued until their 
+      // subfield is processed.
+      OrderingVoxelType const level = q.FrontKey();
+      while(!q.Empty() && q.FrontKey() == level)
+        {
+        OffsetValueType const current = q.FrontValue();
+        IndexType const index = outputImage->ComputeIndex(current);
+        unsigned int subfield = 0;
+        for(unsigned int j = 0; j < InputImageType::ImageDimension; ++j)
+          {
+          subfield |= (index[j] & 1) << j;
+          }
+        subfields[subfield].push_back(current);
+        q.Pop();
+        if(VCollectStatistics)
+          {
+          ++numberOfPops;
+          ++pendingCandidates;
+          }
+        }
 
-        m_BackgroundValue);
       
-      // Add neighbors that are not already in the queue
-      for(unsigned int i = 0; i < connectivity.GetNumberOfNeighbors(); ++i)
+      for(unsigned int subfield = 0; subfield < numberOfSubfields; ++subfield)
         {
-        typename InputImageType::IndexType currentNeighbor;
-        for(unsigned int j = 0; j < ForegroundConnectivity::Dimension; ++j)
+        std::vector<OffsetValueType> const & candidates = subfields[subfield];
+        if(candidates.empty())
           {
-          currentNeighbor[j] = current[j] + 
-
-            connectivity.GetNeighborsPoints()[i][j];
+          continue;
+          }
+        
+        labels.resize(candidates.size());
+        for(unsigned long i = 0; i < candidates.size(); ++i)
+          {
+          states.ResetQueued(candidates[i]);
+          labels[i] = outputBuffer[candidates[i]];
+          }
+        deleted.assign(candidates.size(), 0);
+        
+        // Small subfields are not worth starting the threads
+        unsigned long const minimumCandidatesPerThread = 256;
+        int numberOfThreads = this->GetNumberOfThreads();
+        if(candidates.size() < numberOfThreads*minimumCandidatesPerThread)
+          {
+          numberOfThreads = 
+            1 + candidates.size()/minimumCandidatesPerThread;
+          }
+        
+        if(numberOfThreads == 1)
+          {
+          this->ThinCandidates(candidates, deleted, 0, candidates.size());
+          }
+        else
+          {
+          ThinningThreadStruct str;
+          str.Filter = this;
+          str.Candidates = &candidates;
+          str.Deleted = &deleted;
+          
+          this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+          this->GetMultiThreader()->SetSingleMethod(
+            this->ThinningThreaderCallback, &str);
+          this->GetMultiThreader()->SingleMethodExecute();
           }
         
-        if( /* currentNeighbor is in image */
+        // Queue the neighbors of the deleted points, in the same order as the 
+        // sequential mode would.
+        for(unsigned long i = 0; i < candidates.size(); ++i)
+          {
+          if(deleted[i])
+            {
+            states.Delete(candidates[i]);
+            }
+          }
+        for(unsigned long i = 0; i < candidates.size(); ++i)
+          {
+          if(deleted[i])
+            {
+            unsigned int const pushed = 
+              this->PushNeighbors(candidates[i], labels[i], q, states);
+            if(VCollectStatistics)
+              {
+              ++numberOfDeletions;
+              numberOfRepushes += pushed;
+              peakQueueSize = std::max(peakQueueSize, 
+                                       q.Size() + pendingCandidates);
+              }
+            }
+          progress.CompletedPixel();
+          }
+        
+        if(VCollectStatistics)
+          {
+          pendingCandidates -= candidates.size();
+          }
+        subfields[subfield].clear();
+        }
+      }
+    }
+  
+  if(VCollectStatistics)
+    {
+    // Each candidate is evaluated once by each criterion
+    m_NumberOfPops += numberOfPops;
+    m_NumberOfSimplicityEvaluations += numberOfPops;
+    m_NumberOfTerminalityEvaluations += numberOfPops;
+    m_NumberOfDeletions += numberOfDeletions;
+    m_NumberOfRepushes += numberOfRepushes;
+    m_PeakQueueSize = std::max(m_PeakQueueSize, peakQueueSize);
+    }
+  }
 
-              outputImage->GetPixel(currentNeighbor) == 
 
-              m_ForegroundValue && 
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+template<typename TPointStates>
+unsigned int 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::PushNeighbors(OffsetValueType current, InputPixelType label, 
+                QueueType & q, TPointStates & states)
+  {
+  OrderingVoxelType const * const orderingBuffer = m_WorkOrdering;
+  InputPixelType const * const outputBuffer = m_WorkImage->GetBufferPointer();
+  bool const multiLabel = m_MultiLabel;
+  
+  // Add neighbors that are in the object, not frozen and not already in the
+  // queue. The deletion of a point does not change the topology of the other
+  // labels : only the points of its label are queued.
+  unsigned int pushed = 0;
+  for(unsigned int i = 0; i < m_NeighborOffsets.size(); ++i)
+    {
+    OffsetValueType const neighbor = current + m_NeighborOffsets[i];
+    
+    if(states.IsCandidate(neighbor) && 
+       (!multiLabel || outputBuffer[neighbor] == label))
+      {
+      q.Push(orderingBuffer[neighbor], neighbor);
+      states.SetQueued(neighbor);
+      ++pushed;
+      }
+    }
+  return pushed;
+  }
 
-            /* and not in queue */
-              !inQueue[outputImage->ComputeOffset(currentNeighbor)]   &&
 
-            /*and has not 0 priority*/
-              orderingImage->GetPixel(currentNeighbor) != 
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+ITK_THREAD_RETURN_TYPE
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinningThreaderCallback(void * arg)
+  {
+  MultiThreader::ThreadInfoStruct * info = 
+    static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+  ThinningThreadStruct * str = 
+    static_cast<ThinningThreadStruct *>(info->UserData);
+  
+  unsigned long const size = str->Candidates->size();
+  unsigned long const begin = 
+    (size * info->ThreadID) / info->NumberOfThreads;
+  unsigned long const end = 
+    (size * (info->ThreadID+1)) / info->NumberOfThreads;
+  
+  str->Filter->ThinCandidates(*str->Candidates, *str->Deleted, begin, end);
+  
+  return ITK_THREAD_RETURN_VALUE;
+  }
+
 
-              NumericTraits<typename OrderingImageType::PixelType>::Zero )
-          {
-          q.Push(orderingImage->GetPixel(currentNeighbor), currentNeighbor);
-          inQueue[outputImage->ComputeOffset(currentNeighbor)] = true;
-          }
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinCandidates(std::vector<OffsetValueType> const & candidates, 
+                 std::vector<char> & deleted,
+                 unsigned long begin, unsigned long end)
+  {
+  if(m_MultiLabel)
+    {
+    this->ThinLabelCandidates(candidates, deleted, begin, end, 
+      UseLabelPolicies<(InputImageType::ImageDimension <= 3)>());
+    return;
+    }
+  
+  InputPixelType * const outputBuffer = m_WorkImage->GetBufferPointer();
+  
+  // The candidates of a subfield do not see each other : they are evaluated
+  // by batches before their deletion, and the other threads will not read 
+  // the deleted points.
+  unsigned long const batchSize = Criterion::BatchSize;
+  bool terminal[batchSize];
+  bool simple[batchSize];
+  for(unsigned long batch = begin; batch < end; batch += batchSize)
+    {
+    unsigned long const count = std::min(batchSize, end - batch);
+    m_Terminality->EvaluateAtOffsets(&candidates[batch], count, terminal);
+    m_Simplicity->EvaluateAtOffsets(&candidates[batch], count, simple);
+    for(unsigned long i = 0; i < count; ++i)
+      {
+      if( simple[i] && !terminal[i] )
+        {
+        outputBuffer[candidates[batch+i]] = m_BackgroundValue;
+        deleted[batch+i] = 1;
         }
       }
-    progress.CompletedPixel();
     }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinLabelCandidates(std::vector<OffsetValueType> const & candidates, 
+                      std::vector<char> & deleted,
+                      unsigned long begin, unsigned long end, 
+                      UseLabelPolicies<true>)
+  {
+  InputPixelType * const outputBuffer = m_WorkImage->GetBufferPointer();
   
-  delete[] inQueue;
-}
+  LabelPolicyCriteria criteria;
+  criteria.Simplicity = m_SimplicityPolicy;
+  criteria.Terminality = m_TerminalityPolicy;
+  criteria.Configuration = &m_SimplicityPolicy->GetNeighborhoodConfiguration();
+  criteria.Buffer = outputBuffer;
+  for(unsigned long i = begin; i < end; ++i)
+    {
+    if(criteria.IsDeletable(candidates[i]))
+      {
+      outputBuffer[candidates[i]] = m_BackgroundValue;
+      deleted[i] = 1;
+      }
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity, 
+         typename TOrderingImage, typename TSimplicityPolicy, 
+         typename TTerminalityPolicy>
+void 
+SkeletonizeImageFilter<TImage, TForegroundConnectivity, TOrderingImage, 
+                       TSimplicityPolicy, TTerminalityPolicy>
+::ThinLabelCandidates(std::vector<OffsetValueType> const &, 
+                      std::vector<char> &, unsigned long, unsigned long, 
+                      UseLabelPolicies<false>)
+  {
+  // Never called : GenerateData rejects the parallel multi-label mode 
+  // without the label policies.
+  }
 
 } // namespace itk
 
@@ -0,0 +1,150 @@
+#ifndef itkSurfaceTerminalityImageFunction_h
+#define itkSurfaceTerminalityImageFunction_h
+
+#include "itkBinaryImageFunction.h"
+
+#include "itkBackgroundConnectivity.h"
+
+namespace itk
+{
+
+/**
+ * @brief Test if a point is on a surface of the object, i.e. if both points
+ * of a pair of opposite face neighbors are in the background.
+ *
+ * Such a point has the object only on one layer along an axis : it is on a
+ * part of the object that is one point thick, and may be on the border of
+ * that part. Used as the terminality criterion of SkeletonizeImageFilter,
+ * it keeps the thin parts once the thinning has reached them, and the
+ * skeleton is a medial surface (together with the curves of the object that
+ * are one point thick) instead of a curve skeleton.
+ *
+ * The background topological number is not used : a point with a
+ * background topological number larger than 1 is never simple, hence never
+ * deleted, so it cannot tell the borders of the surfaces.
+ *
+ * Up to the dimension 3, the test is done on the packed configuration of
+ * the neighborhood, with one mask per axis.
+ */
+template<typename TImage,
+         typename TForegroundConnectivity,
+         typename TBackgroundConnectivity =
+           typename BackgroundConnectivity<TForegroundConnectivity>::Type  >
+class ITK_EXPORT SurfaceTerminalityImageFunction :
+  public itk::BinaryImageFunction<TImage, bool >
+  {
+  public :
+    /**
+     * @name Standard ITK declarations
+     */
+    //@{
+    typedef SurfaceTerminalityImageFunction Self;
+    typedef itk::BinaryImageFunction<TImage, bool > Superclass;
+    typedef itk::SmartPointer<Self> Pointer;
+    typedef itk::SmartPointer<Self const> ConstPointer;
+
+    itkNewMacro(Self);
+    itkTypeMacro(SurfaceTerminalityImageFunction, BinaryImageFunction);
+
+    typedef typename Superclass::PointType PointType;
+    typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
+    typedef typename Superclass::IndexType IndexType;
+    typedef typename Superclass::OffsetValueType OffsetValueType;
+    typedef typename Superclass::InputPixelType InputPixelType;
+    typedef typename Superclass::NeighborhoodConfigurationType
+      NeighborhoodConfigurationType;
+    typedef typename Superclass::ConfigurationType ConfigurationType;
+    //@}
+
+    /**
+     * @brief Initialize the masks of the pairs of opposite face neighbors.
+     */
+    SurfaceTerminalityImageFunction();
+
+    /**
+     * @name Evaluation functions
+     *
+     * These functions test if the point is on a surface.
+     */
+    //@{
+    bool Evaluate(PointType const & point) const;
+
+    bool EvaluateAtIndex(IndexType const & index) const;
+
+    bool EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const;
+
+    /**
+     * @brief Evaluate the terminality at an offset of the buffer. This
+     * function is not virtual, so that it may be inlined when the type of
+     * the functor is known, e.g. by SkeletonizeImageFilter.
+     */
+    bool EvaluateAtOffset(OffsetValueType offset) const;
+
+    /**
+     * @brief Evaluate the terminality at an offset of the buffer, with the
+     * given foreground value, e.g. the label of the point in a label map.
+     * Only up to the dimension 3.
+     */
+    bool EvaluateAtOffset(OffsetValueType offset,
+                          InputPixelType const & foregroundValue) const;
+
+    /**
+     * @brief Evaluate the terminality on the configuration gathered around
+     * a point, testing it against the masks of the axes. Only up to the
+     * dimension 3.
+     */
+    bool EvaluateConfiguration(ConfigurationType configuration) const;
+
+    /**
+     * @brief Batch evaluation, testing the configurations of the points
+     * gathered at once.
+     */
+    void EvaluateAtOffsets(OffsetValueType const * offsets,
+                           unsigned long count, bool * results) const;
+
+    /** @brief Batch evaluation at indices, through EvaluateAtOffsets. */
+    void EvaluateAtIndices(IndexType const * indices, unsigned long count,
+                           bool * results) const
+      {
+      this->EvaluateAtIndicesByOffsets(indices, count, results);
+      }
+    //@}
+
+  private :
+    SurfaceTerminalityImageFunction(Self const &); // not implemented
+    Self & operator=(Self const &); // not implemented
+
+    /**
+     * @brief Tag selecting the evaluation on the packed configuration, up to
+     * the dimension 3.
+     */
+    template<bool VUseConfiguration>
+    struct UseConfiguration {};
+
+    bool EvaluateAtIndex(IndexType const & index, UseConfiguration<true>) const;
+    bool EvaluateAtIndex(IndexType const & index, UseConfiguration<false>) const;
+
+    bool EvaluateAtOffset(OffsetValueType offset, UseConfiguration<true>) const;
+    bool EvaluateAtOffset(OffsetValueType offset, UseConfiguration<false>) const;
+
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           bool * results, UseConfiguration<true>) const;
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           bool * results, UseConfiguration<false>) const;
+
+    /**
+     * @brief Configuration of the two face neighbors along each axis, used
+     * up to the dimension 3.
+     */
+    ConfigurationType m_FaceNeighborsMasks[TImage::ImageDimension];
+  };
+
+}
+
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkSurfaceTerminalityImageFunction.txx"
+
+#endif
+
+#endif // itkSurfaceTerminalityImageFunction_h
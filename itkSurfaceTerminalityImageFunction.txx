@@ -0,0 +1,223 @@
+#ifndef itkSurfaceTerminalityImageFunction_txx
+#define itkSurfaceTerminalityImageFunction_txx
+
+#include <algorithm>
+
+#include "itkSurfaceTerminalityImageFunction.h"
+
+namespace itk
+{
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::SurfaceTerminalityImageFunction()
+  {
+  // The face neighbors along an axis are the points of the unit cube at
+  // +/- 3^axis from the center.
+  unsigned int const center = NeighborhoodConfigurationType::NeighborhoodSize/2;
+  unsigned int stride = 1;
+  for(unsigned int axis=0; axis<TImage::ImageDimension; ++axis)
+    {
+    m_FaceNeighborsMasks[axis] = 0;
+    if(TImage::ImageDimension <= 3)
+      {
+      m_FaceNeighborsMasks[axis] =
+        NeighborhoodConfigurationType::GetBit(center-stride) |
+        NeighborhoodConfigurationType::GetBit(center+stride);
+      }
+    stride *= 3;
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::Evaluate(PointType const & point) const
+  {
+  typename TImage::IndexType index;
+  this->ConvertPointToNearestIndex(point, index);
+  return EvaluateAtIndex(index);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index) const
+  {
+  return this->EvaluateAtIndex(index,
+    UseConfiguration<(TImage::ImageDimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseConfiguration<true>) const
+  {
+  return this->EvaluateConfiguration(this->m_NeighborhoodConfiguration.GatherAtIndex(
+    index, this->m_ForegroundValue));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseConfiguration<false>) const
+  {
+  for(unsigned int axis=0; axis<TImage::ImageDimension; ++axis)
+    {
+    IndexType before = index;
+    IndexType after = index;
+    --before[axis];
+    ++after[axis];
+    if(this->GetInputImage()->GetPixel(before) != this->m_ForegroundValue &&
+       this->GetInputImage()->GetPixel(after) != this->m_ForegroundValue)
+      {
+      return true;
+      }
+    }
+  return false;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset) const
+  {
+  return this->EvaluateAtOffset(offset,
+    UseConfiguration<(TImage::ImageDimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, UseConfiguration<true>) const
+  {
+  return this->EvaluateAtOffset(offset, this->m_ForegroundValue);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset,
+                   InputPixelType const & foregroundValue) const
+  {
+  return this->EvaluateConfiguration(this->m_NeighborhoodConfiguration.Gather(
+    offset, foregroundValue));
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffset(OffsetValueType offset, UseConfiguration<false>) const
+  {
+  return this->EvaluateAtIndex(this->GetInputImage()->ComputeIndex(offset),
+                               UseConfiguration<false>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+void
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                    bool * results) const
+  {
+  this->EvaluateAtOffsets(offsets, count, results,
+    UseConfiguration<(TImage::ImageDimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+void
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                    bool * results, UseConfiguration<true>) const
+  {
+  ConfigurationType configurations[Superclass::BatchSize];
+  for(unsigned long batch = 0; batch < count; batch += Superclass::BatchSize)
+    {
+    unsigned long const batchCount =
+      std::min<unsigned long>(Superclass::BatchSize, count - batch);
+    this->m_NeighborhoodConfiguration.Gather(offsets + batch, batchCount,
+      this->m_ForegroundValue, configurations);
+    for(unsigned long i = 0; i < batchCount; ++i)
+      {
+      results[batch+i] = this->EvaluateConfiguration(configurations[i]);
+      }
+    }
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+void
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                    bool * results, UseConfiguration<false>) const
+  {
+  this->Superclass::EvaluateAtOffsets(offsets, count, results);
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateConfiguration(ConfigurationType configuration) const
+  {
+  for(unsigned int axis=0; axis<TImage::ImageDimension; ++axis)
+    {
+    if((configuration & m_FaceNeighborsMasks[axis]) == 0)
+      {
+      return true;
+      }
+    }
+  return false;
+  }
+
+
+template<typename TImage, typename TForegroundConnectivity,
+         typename TBackgroundConnectivity >
+bool
+SurfaceTerminalityImageFunction<TImage, TForegroundConnectivity,
+                                TBackgroundConnectivity>
+::EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const
+  {
+  typename TImage::IndexType index;
+  this->ConvertContinuousIndexToNearestIndex(contIndex, index);
+  return EvaluateAtIndex(index);
+  }
+
+}
+
+#endif // itkSurfaceTerminalityImageFunction_txx
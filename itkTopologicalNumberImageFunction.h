@@ -6,6 +6,7 @@
 #include "itkBinaryImageFunction.h"
 
 #include "itkBackgroundConnectivity.h"
+#include "itkSimplePointLookupTable.h"
 #include "itkUnitCubeCCCounter.h"
 
 namespace itk
@@ -34,9 +35,8 @@ class ITK_EXPORT TopologicalNumberImageFunction :
      */
     //@{
     typedef TopologicalNumberImageFunction Self;
-    typedef itk::ImageFunction<TImage, std::pair<unsigned int, unsigned int> > 
-
-      Superclass;
+    typedef itk::BinaryImageFunction<TImage, 
+      std::pair<unsigned int, unsigned int> > Superclass;
     typedef itk::SmartPointer<Self> Pointer;
     typedef itk::SmartPointer<Self const> ConstPointer;
 
@@ -46,6 +46,7 @@ class ITK_EXPORT TopologicalNumberImageFunction :
     typedef typename Superclass::PointType PointType;
     typedef typename Superclass::ContinuousIndexType ContinuousIndexType;
     typedef typename Superclass::IndexType IndexType;
+    typedef typename Superclass::OffsetValueType OffsetValueType;
     //@}
     
     /**
@@ -71,6 +72,20 @@ class ITK_EXPORT TopologicalNumberImageFunction :
     std::pair<unsigned int, unsigned int> 
 
       EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const;
+    
+    /** 
+     * @brief Batch evaluation, computing the topological numbers of the 
+     * configurations of the points gathered at once.
+     */
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           std::pair<unsigned int, unsigned int> * results) const;
+    
+    /** @brief Batch evaluation at indices, through EvaluateAtOffsets. */
+    void EvaluateAtIndices(IndexType const * indices, unsigned long count,
+                           std::pair<unsigned int, unsigned int> * results) const
+      {
+      this->EvaluateAtIndicesByOffsets(indices, count, results);
+      }
     //@}
 
     /**
@@ -90,14 +105,42 @@ class ITK_EXPORT TopologicalNumberImageFunction :
     //@}
 
   private :
-    static UnitCubeCCCounter< TFGConnectivity > m_ForegroundUnitCubeCCCounter;
-    static UnitCubeCCCounter< TBGConnectivity > m_BackgroundUnitCubeCCCounter;
+    itkStaticConstMacro(NeighborhoodSize, unsigned int,
+                        UnitCubeSize<TFGConnectivity::Dimension>::Value);
+
+    // The counters have no state, they may be shared by all threads
+    static UnitCubeCCCounter< TFGConnectivity > const 
+      m_ForegroundUnitCubeCCCounter;
+    static UnitCubeCCCounter< TBGConnectivity > const 
+      m_BackgroundUnitCubeCCCounter;
     
     TopologicalNumberImageFunction(Self const &); // not implemented
     Self & operator=(Self const &); // not implemented
+
+    /** 
+     * @brief Tag selecting the evaluation on the packed configuration, up to 
+     * the dimension 3.
+     */
+    template<bool VUseConfiguration>
+    struct UseConfiguration {};
+
+    std::pair<unsigned int, unsigned int> 
+      EvaluateAtIndex(IndexType const & index, UseConfiguration<true>) const;
+    std::pair<unsigned int, unsigned int> 
+      EvaluateAtIndex(IndexType const & index, UseConfiguration<false>) const;
+    
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           std::pair<unsigned int, unsigned int> * results, 
+                           UseConfiguration<true>) const;
+    void EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                           std::pair<unsigned int, unsigned int> * results, 
+                           UseConfiguration<false>) const;
     
     bool m_ComputeForegroundTN;
     bool m_ComputeBackgroundTN;    
+
+    /** @brief Offsets of the points of the unit cube. */
+    Offset<TFGConnectivity::Dimension> m_UnitCubeOffsets[NeighborhoodSize];
   };
 
 }
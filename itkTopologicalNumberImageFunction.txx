@@ -1,6 +1,8 @@
 #ifndef itkTopologicalNumberImageFunction_txx
 #define itkTopologicalNumberImageFunction_txx
 
+#include <algorithm>
+
 #include <itkNumericTraits.h>
 
 
@@ -15,6 +17,15 @@ TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
 ::TopologicalNumberImageFunction()
 : m_ComputeForegroundTN(true), m_ComputeBackgroundTN(true)
   {
+  for(unsigned int i=0; i<NeighborhoodSize; ++i)
+    {
+    int remainder = i;
+    for(unsigned int j=0; j<TFGConnectivity::Dimension; ++j)
+      {
+      m_UnitCubeOffsets[i][j] = remainder % 3 - 1;
+      remainder /= 3;
+      }
+    }
   }
 
 template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
@@ -23,7 +34,7 @@ TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
 ::Evaluate(PointType const & point) const
   {
   typename TImage::IndexType index;
-  ConvertPointToNearestIndex(point, index);
+  this->ConvertPointToNearestIndex(point, index);
   return EvaluateAtIndex(index);
   }
 
@@ -33,32 +44,46 @@ std::pair<unsigned int, unsigned int>
 TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
 ::EvaluateAtIndex(IndexType const & index) const
   {
-  unsigned int const imageSize = 
+  return this->EvaluateAtIndex(index, 
+    UseConfiguration<(TFGConnectivity::Dimension <= 3)>());
+  }
+
 
-    TFGConnectivity::GetInstance().GetNeighborhoodSize();
-  char* subImage = new char[imageSize];
+template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
+std::pair<unsigned int, unsigned int> 
+TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseConfiguration<true>) const
+  {
+  typedef SimplePointLookupTable<TFGConnectivity, TBGConnectivity> TableType;
+  TableType const & table = TableType::GetInstance();
+  
+  typename TableType::ConfigurationType const configuration = 
+    this->m_NeighborhoodConfiguration.GatherAtIndex(index, 
+                                                    this->m_ForegroundValue);
+  
+  unsigned int const ccNumber = m_ComputeForegroundTN ? 
+    table.ComputeForegroundTopologicalNumber(configuration) : 0;
+  unsigned int const backgroundCcNumber = m_ComputeBackgroundTN ? 
+    table.ComputeBackgroundTopologicalNumber(configuration) : 0;
+  
+  return std::pair<unsigned int, unsigned int>(ccNumber, backgroundCcNumber);
+  }
+
+
+template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
+std::pair<unsigned int, unsigned int> 
+TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
+::EvaluateAtIndex(IndexType const & index, UseConfiguration<false>) const
+  {
+  unsigned int const imageSize = NeighborhoodSize;
+  char subImage[NeighborhoodSize];
   
   // Get the sub-image
   for(unsigned int i=0; i<imageSize; ++i)
     {
-    int remainder = i;
-    itk::Offset<TFGConnectivity::Dimension> offset;
-
-    // Get current offset
-    for(unsigned int j=0; j<TFGConnectivity::Dimension; ++j)
-      {
-      offset[j] = remainder % 3;
-      remainder -= offset[j];
-      remainder /= 3;
-      --offset[j];
-      }
-    
     subImage[i] = 
-
-      (this->GetInputImage()->GetPixel(index+offset) ==
-
+      (this->GetInputImage()->GetPixel(index+m_UnitCubeOffsets[i]) ==
         this->m_ForegroundValue)?
-
       255:0;
     }
 
@@ -67,33 +92,23 @@ TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
   subImage[middle] = 0;
   
   // Topological number in the foreground
-  m_ForegroundUnitCubeCCCounter.SetImage(subImage, subImage+imageSize);
   unsigned int const ccNumber = 
-
-    m_ComputeForegroundTN ? m_ForegroundUnitCubeCCCounter() : 0;
+    m_ComputeForegroundTN ? m_ForegroundUnitCubeCCCounter(subImage) : 0;
   
   // Invert the sub-image
-  for(int bit = 0; bit<middle; ++bit)
+  for(unsigned int bit = 0; bit<middle; ++bit)
     {
     subImage[bit] = 255 - subImage[bit];
     }
-  for(int bit=middle; bit<imageSize-1; ++bit)
+  for(unsigned int bit=middle; bit<imageSize-1; ++bit)
     {
     subImage[bit+1] = 255 - subImage[bit+1];
     }
   
   // Topological number in the background
-  m_BackgroundUnitCubeCCCounter.SetImage(subImage, 
-
-    subImage+TBGConnectivity::GetInstance().GetNeighborhoodSize());
-  assert(TFGConnectivity::GetInstance().GetNeighborsPoints());
-  
   unsigned int const backgroundCcNumber = 
-
-    m_ComputeBackgroundTN ? m_BackgroundUnitCubeCCCounter() : 0;
+    m_ComputeBackgroundTN ? m_BackgroundUnitCubeCCCounter(subImage) : 0;
   
-  delete[] subImage;
-
   return std::pair<unsigned int, unsigned int>(ccNumber, backgroundCcNumber);
   }
 
@@ -104,19 +119,69 @@ TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
 ::EvaluateAtContinuousIndex(ContinuousIndexType const & contIndex) const
   {
   typename TImage::IndexType index;
-  ConvertContinuousIndexToNearestIndex(contIndex, index);
+  this->ConvertContinuousIndexToNearestIndex(contIndex, index);
   return EvaluateAtIndex(index);
   }
 
 
 template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
-UnitCubeCCCounter< TFGConnectivity > 
+void
+TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                    std::pair<unsigned int, unsigned int> * results) const
+  {
+  this->EvaluateAtOffsets(offsets, count, results, 
+    UseConfiguration<(TFGConnectivity::Dimension <= 3)>());
+  }
+
+
+template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
+void
+TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                    std::pair<unsigned int, unsigned int> * results, 
+                    UseConfiguration<true>) const
+  {
+  typedef SimplePointLookupTable<TFGConnectivity, TBGConnectivity> TableType;
+  TableType const & table = TableType::GetInstance();
+  
+  typename TableType::ConfigurationType configurations[Superclass::BatchSize];
+  for(unsigned long batch = 0; batch < count; batch += Superclass::BatchSize)
+    {
+    unsigned long const batchCount = 
+      std::min<unsigned long>(Superclass::BatchSize, count - batch);
+    this->m_NeighborhoodConfiguration.Gather(offsets + batch, batchCount, 
+      this->m_ForegroundValue, configurations);
+    for(unsigned long i = 0; i < batchCount; ++i)
+      {
+      results[batch+i].first = m_ComputeForegroundTN ? 
+        table.ComputeForegroundTopologicalNumber(configurations[i]) : 0;
+      results[batch+i].second = m_ComputeBackgroundTN ? 
+        table.ComputeBackgroundTopologicalNumber(configurations[i]) : 0;
+      }
+    }
+  }
+
+
+template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
+void
+TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
+::EvaluateAtOffsets(OffsetValueType const * offsets, unsigned long count,
+                    std::pair<unsigned int, unsigned int> * results, 
+                    UseConfiguration<false>) const
+  {
+  this->Superclass::EvaluateAtOffsets(offsets, count, results);
+  }
+
+
+template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
+UnitCubeCCCounter< TFGConnectivity > const
 TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
 ::m_ForegroundUnitCubeCCCounter = UnitCubeCCCounter< TFGConnectivity >();
 
 
 template<typename TImage, typename TFGConnectivity, typename TBGConnectivity >
-UnitCubeCCCounter< TBGConnectivity > 
+UnitCubeCCCounter< TBGConnectivity > const
 TopologicalNumberImageFunction<TImage, TFGConnectivity, TBGConnectivity>
 ::m_BackgroundUnitCubeCCCounter = UnitCubeCCCounter< TBGConnectivity >();
 
@@ -12,6 +12,10 @@ namespace itk
  * @brief Functor counting the number of connected components restricted in a 
  * unit cube. This class is used for topological number computation, and 
  * should be mostly useless in any other cases.
+ *
+ * The functor has no state : the image is passed to operator(), and the
+ * scratch space is allocated on the stack, so that a single counter may be
+ * used by several threads at the same time.
  */
 template< typename TConnectivity, 
 
@@ -21,13 +25,15 @@ template< typename TConnectivity,
 class ITK_EXPORT UnitCubeCCCounter
   {
   public :
-    UnitCubeCCCounter();
-    ~UnitCubeCCCounter();
-    
-    unsigned int operator()() const;
-    
-    template<typename Iterator>
-    void SetImage(Iterator imageBegin, Iterator imageEnd);
+    /** @brief Number of points in the unit cube. */
+    itkStaticConstMacro(NeighborhoodSize, unsigned int,
+                        UnitCubeSize<TConnectivity::Dimension>::Value);
+
+    /**
+     * @brief Count the connected components of image, an array of 
+     * NeighborhoodSize values where 0 is the background.
+     */
+    unsigned int operator()(char const * image) const;
       
   private :
     template<typename C>
@@ -36,8 +42,6 @@ class ITK_EXPORT UnitCubeCCCounter
     static std::vector<bool> const m_NeighborhoodConnectivityTest;
     static std::vector<bool> const m_ConnectivityTest;
     
-    char* m_Image;
-    
     static UnitCubeNeighbors<TConnectivity, TNeighborhoodConnectivity > const m_UnitCubeNeighbors;
   };
 
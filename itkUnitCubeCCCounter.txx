@@ -3,92 +3,66 @@
 
 #include "itkUnitCubeCCCounter.h"
 
-#include <list>
-#include <queue>
+#include <algorithm>
 
 namespace itk
 {
 
-template<typename TConnectivity, typename TNeighborhoodConnectivity>
-UnitCubeCCCounter<TConnectivity, TNeighborhoodConnectivity>
-::UnitCubeCCCounter()
-: m_Image(new char[TConnectivity::GetInstance().GetNeighborhoodSize()])
-  {
-  }
-
-
-template<typename TConnectivity, typename TNeighborhoodConnectivity>
-UnitCubeCCCounter<TConnectivity, TNeighborhoodConnectivity>
-::~UnitCubeCCCounter()
-  {
-  delete[] m_Image;
-  }
-
-
-template<typename TConnectivity, typename TNeighborhoodConnectivity>
-template<typename Iterator>
-void
-UnitCubeCCCounter<TConnectivity, TNeighborhoodConnectivity>
-::SetImage(Iterator imageBegin, Iterator imageEnd)
-  {
-  std::copy(imageBegin, imageEnd, m_Image);
-  }
-
 template<typename TConnectivity, typename TNeighborhoodConnectivity>
 unsigned int 
 UnitCubeCCCounter<TConnectivity, TNeighborhoodConnectivity>
-::operator()() const
+::operator()(char const * image) const
   {
-  unsigned int const neighborhoodSize = 
-
-    TConnectivity::GetInstance().GetNeighborhoodSize();
   unsigned int seed=0;
+  
   // Find first seed
-  while(seed != neighborhoodSize && 
-
-         (m_Image[seed] == 0 || !m_ConnectivityTest[seed] ) )
+  while(seed != NeighborhoodSize && 
+        (image[seed] == 0 || !m_ConnectivityTest[seed] ) )
     {
     ++seed;
     }
-
-  std::vector<bool> processed(neighborhoodSize, false);
+  
+  bool processed[NeighborhoodSize];
+  std::fill(processed, processed+NeighborhoodSize, false);
+  
+  // Each point is queued at most once, so the queue is a plain array
+  unsigned int queue[NeighborhoodSize];
+  
   unsigned int nbCC=0;
-  while(seed != neighborhoodSize)
+  while(seed != NeighborhoodSize)
     {
     ++nbCC;
     processed[seed] = true;
     
-    std::queue<unsigned int, std::list<unsigned int> > q;
-    q.push(seed);
+    unsigned int queueBegin = 0;
+    unsigned int queueEnd = 0;
+    queue[queueEnd++] = seed;
     
-    while(!q.empty())
+    while(queueBegin != queueEnd)
       {
-      unsigned int const current = q.front();
-      q.pop();
+      unsigned int const current = queue[queueBegin++];
       
       // For each neighbor check if m_UnitCubeNeighbors is true.
-      for(unsigned int neighbor = 0; neighbor < neighborhoodSize; ++neighbor)
+      for(unsigned int neighbor = 0; neighbor < NeighborhoodSize; ++neighbor)
         {
-        if(!processed[neighbor] && m_Image[neighbor] !=0 && 
-
+        if(!processed[neighbor] && image[neighbor] !=0 && 
            m_UnitCubeNeighbors(current, neighbor))
           {
-          q.push(neighbor);
+          queue[queueEnd++] = neighbor;
           processed[neighbor] = true;
           }
         }
       }
     
     // Look for next seed
-    while(seed != neighborhoodSize && 
-
-          ( processed[seed] || m_Image[seed] == 0 || !m_ConnectivityTest[seed] ) 
-
+    while(seed != NeighborhoodSize && 
+          ( processed[seed] || image[seed] == 0 || !m_ConnectivityTest[seed] ) 
          )
       {
       ++seed;
       }
     }
+  
   return nbCC;
   }
 
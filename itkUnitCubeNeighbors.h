@@ -1,13 +1,27 @@
 #ifndef itkUnitCubeNeighbors_h
 #define itkUnitCubeNeighbors_h
 
-#include <vector>
-
 #include "itkNeighborhoodConnectivity.h"
 
 namespace itk
 {
 
+/**
+ * @brief Number of points in the unit cube [-1, 1]^n, known at compile time.
+ */
+template<unsigned int VDimension>
+struct UnitCubeSize
+  {
+  itkStaticConstMacro(Value, unsigned int,
+                      3 * UnitCubeSize<VDimension-1>::Value);
+  };
+
+template<>
+struct UnitCubeSize<0>
+  {
+  itkStaticConstMacro(Value, unsigned int, 1);
+  };
+
 /**
  * @brief For each point in the n'-neighborhood of 0, characterizes which of 
  * its surrounding points are n-neighbors and belong to the [-1, 1] cube.
@@ -42,8 +56,9 @@ class ITK_EXPORT UnitCubeNeighbors
     bool operator()(Offset const p1, Offset const p2) const;
       
   private :
-    int const neighborhoodSize;    
-    std::vector<std::vector<bool> > neighborsInUnitCube;
+    itkStaticConstMacro(NeighborhoodSize, unsigned int, 
+                        UnitCubeSize<Connectivity::Dimension>::Value);
+    bool neighborsInUnitCube[NeighborhoodSize][NeighborhoodSize];
   };
 
 }
@@ -11,54 +11,52 @@ namespace itk
 template<typename Connectivity, typename NeighborhoodConnectivity>
 UnitCubeNeighbors<Connectivity, NeighborhoodConnectivity>
 ::UnitCubeNeighbors()
-: neighborhoodSize(
-
-    static_cast<int>(std::pow(3.f, static_cast<float>(Connectivity::Dimension)))), 
-  neighborsInUnitCube(
-
-    std::vector<std::vector<bool> >(
-
-      neighborhoodSize , std::vector<bool>(neighborhoodSize, false) ) )
   {
   assert(static_cast<int>(Connectivity::Dimension) == static_cast<int>(NeighborhoodConnectivity::Dimension));
   Connectivity const & connectivity = Connectivity::GetInstance();
   NeighborhoodConnectivity const & neighborhoodConnectivity = 
-
     NeighborhoodConnectivity::GetInstance();
   
-  for(int neighbor1 = 0; neighbor1 < neighborhoodSize; ++neighbor1)
+  for(unsigned int neighbor1 = 0; neighbor1 < NeighborhoodSize; ++neighbor1)
     {
     // convert i to Connectivity::OffsetType
     Point const p1 = connectivity.OffsetToPoint(neighbor1);
-            
-    if(neighborhoodConnectivity.IsInNeighborhood(p1) )
+    bool const inNeighborhood = 
+      neighborhoodConnectivity.IsInNeighborhood(neighbor1);
+    
+    for(unsigned int neighbor2 = 0; neighbor2 < NeighborhoodSize; ++neighbor2)
       {
-      for(int neighbor2 = 0; neighbor2 < neighborhoodSize; ++neighbor2)
+      neighborsInUnitCube[neighbor1][neighbor2] = false;
+      }
+    
+    if(inNeighborhood)
+      {
+      for(unsigned int neighbor2 = 0; neighbor2 < NeighborhoodSize; ++neighbor2)
         {
-        // convert i to Connectivity::OffsetType
-        Point const p2 = connectivity.OffsetToPoint(neighbor2);
-        
-        Point sum;
-        for(unsigned int i=0; i<Connectivity::Dimension; ++i)
+        // p2 is the difference between p1 and p1+p2 : they are neighbors if
+        // p2 is in the neighborhood of 0.
+        if(!connectivity.IsInNeighborhood(neighbor2))
           {
-          sum[i] = p1[i] + p2[i];
+          continue;
           }
-        unsigned int const sumOffset = connectivity.PointToOffset(sum);
         
+        Point const p2 = connectivity.OffsetToPoint(neighbor2);
+        
+        Point sum;
         bool inUnitCube = true;
         for(unsigned int dim = 0; 
-
             dim < Connectivity::Dimension && inUnitCube; ++dim)
           {
+          sum[dim] = p1[dim] + p2[dim];
           if(sum[dim] < -1 || sum[dim] > +1) 
             {
             inUnitCube = false;
             }
           }
         
-        if(inUnitCube && connectivity.AreNeighbors(p1, sum) )
+        if(inUnitCube)
           {
-          neighborsInUnitCube[neighbor1][sumOffset] = true;
+          neighborsInUnitCube[neighbor1][connectivity.PointToOffset(sum)] = true;
           }
         }
       }
@@ -90,9 +88,9 @@ UnitCubeNeighbors<Connectivity, NeighborhoodConnectivity>
 
                NeighborhoodConnectivity>::Point const p2) const
   {
-  Connectivity const & connectivity = Connectivity::getInstance();
-  Offset const o1 = connectivity.pointToOffset(p1);
-  Offset const o2 = connectivity.pointToOffset(p2);
+  Connectivity const & connectivity = Connectivity::GetInstance();
+  Offset const o1 = connectivity.PointToOffset(p1);
+  Offset const o2 = connectivity.PointToOffset(p2);
   return operator()(o1, o2);
   }
 
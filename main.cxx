@@ -4,53 +4,99 @@
 #include <itkImageFileWriter.h>
 #include <itkImage.h>
 
+#include "itkConnectivity.h"
 #include "itkSkeletonizeImageFilter.h"
 
 #include "itkChamferDistanceTransformImageFilter.h"
 #include "itkSimpleFilterWatcher.h"
 
-int main(int argc, char** argv)
+const int dim = 3;
+typedef itk::Image<unsigned char, dim> Image;
+
+/**
+ * Skeletonize the image with the connectivity selected by
+ * itk::ConnectivityDispatcher : each connectivity has its own fully 
+ * specialized skeletonizer.
+ */
+struct Skeletonize
 {
+  Image::Pointer image;
+  Image::Pointer skeleton;
+  Image::PixelType foreground;
+  Image::PixelType background;
 
-  if( argc != 5 )
+  template<typename TConnectivity>
+  void operator()(TConnectivity const &)
     {
-    std::cerr << "usage: " << argv[0] << " input output fg bg" << std::endl;
-    // std::cerr << "  : " << std::endl;
-    exit(1);
-    }
-
-    const int dim = 3;
-    typedef itk::Image<unsigned char, dim> Image;
-    
-    itk::ImageFileReader<Image>::Pointer reader = itk::ImageFileReader<Image>::New();
-    reader->SetFileName(argv[1]);
-    reader->Update();
-    
-    Image::Pointer image = reader->GetOutput();
+    typedef itk::SkeletonizeImageFilter<Image, TConnectivity> Skeletonizer;
     
-    typedef itk::SkeletonizeImageFilter<Image, itk::Connectivity<dim, 0> > Skeletonizer;
-    
-    typedef itk::ChamferDistanceTransformImageFilter<Image, Skeletonizer::OrderingImageType> DistanceMapFilterType;
-    DistanceMapFilterType::Pointer distanceMapFilter = DistanceMapFilterType::New();
+    // The distance map is computed by the skeletonizer, which initializes
+    // its queue from the points listed by the distance filter.
+    typedef typename Skeletonizer::DistanceFilterType DistanceMapFilterType;
+    typename DistanceMapFilterType::Pointer distanceMapFilter = DistanceMapFilterType::New();
     unsigned int weights[] = { 3, 4, 5 };
     distanceMapFilter->SetDistanceFromObject( false );
     distanceMapFilter->SetWeights(weights, weights+3);
-    distanceMapFilter->SetInput(image);
-    distanceMapFilter->SetForegroundValue( atoi(argv[3]) );
+    distanceMapFilter->SetForegroundValue( foreground );
 //     itk::SimpleFilterWatcher watcher(distanceMapFilter, "distanceMapFilter");
 //     distanceMapFilter->Update();
     
-    Skeletonizer::Pointer skeletonizer = Skeletonizer::New();
+    typename Skeletonizer::Pointer skeletonizer = Skeletonizer::New();
     skeletonizer->SetInput(image);
-    skeletonizer->SetOrderingImage(distanceMapFilter->GetOutput());
-    skeletonizer->SetForegroundValue( atoi(argv[3]) );
-    skeletonizer->SetBackgroundValue( atoi(argv[4]) );
+    skeletonizer->SetDistanceFilter(distanceMapFilter);
+    skeletonizer->SetForegroundValue( foreground );
+    skeletonizer->SetBackgroundValue( background );
     itk::SimpleFilterWatcher watcher2(skeletonizer, "skeletonizer");
+    skeletonizer->Update();
+    
+    skeleton = skeletonizer->GetOutput();
+    }
+};
+
+int main(int argc, char** argv)
+{
+
+  if( argc != 5 && argc != 6 )
+    {
+    std::cerr << "usage: " << argv[0] << " input output fg bg [neighbors]" << std::endl;
+    std::cerr << "  neighbors : 6, 18 or 26 (default)" << std::endl;
+    exit(1);
+    }
+
+  // The connectivity set from the command line is checked by the run-time
+  // connectivity, which throws on an unsupported number of neighbors.
+  try
+    {
+    itk::ImageFileReader<Image>::Pointer reader = itk::ImageFileReader<Image>::New();
+    reader->SetFileName(argv[1]);
+    reader->Update();
+    
+    // The connectivity is chosen at run time, and converted to its cell 
+    // dimension by the run-time connectivity.
+    typedef itk::Connectivity<dim> ConnectivityType;
+    ConnectivityType::Pointer connectivity = ConnectivityType::New();
+    connectivity->SetFullyConnected( true );
+    if( argc == 6 )
+      {
+      connectivity->SetNumberOfNeighbors( atoi(argv[5]) );
+      }
+    
+    Skeletonize skeletonize;
+    skeletonize.image = reader->GetOutput();
+    skeletonize.foreground = atoi(argv[3]);
+    skeletonize.background = atoi(argv[4]);
+    itk::ConnectivityDispatcher<dim>::Dispatch(*connectivity, skeletonize);
     
     itk::ImageFileWriter<Image>::Pointer writer = itk::ImageFileWriter<Image>::New();
     writer->SetFileName(argv[2]);
-    writer->SetInput(skeletonizer->GetOutput());
+    writer->SetInput(skeletonize.skeleton);
     writer->Update();
-    
-    return EXIT_SUCCESS;
+    }
+  catch(itk::ExceptionObject & e)
+    {
+    std::cerr << e << std::endl;
+    return EXIT_FAILURE;
+    }
+  
+  return EXIT_SUCCESS;
 }
@@ -0,0 +1,157 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include "itkConnectivity.h"
+#include "itkLineTerminalityImageFunction.h"
+#include "itkSkeletonizeImageFilter.h"
+#include "skeletonTestHelpers.h"
+
+typedef itk::SkeletonizeImageFilter<ImageType, itk::Connectivity<3, 0> >
+  SkeletonizerType;
+typedef itk::LineTerminalityImageFunction<ImageType, itk::Connectivity<3, 0> >
+  TerminalityType;
+
+/** Paths of the thinning tested. */
+enum Mode { Sequential, Parallel, RuntimeCriteria };
+
+/**
+ * Skeleton of a binary image with foreground 255, or of all the labels of a
+ * label map at once.
+ */
+ImageType::Pointer skeletonize(ImageType const * image, bool multiLabel,
+                               Mode mode)
+  {
+  DistanceFilterType::Pointer distanceFilter = newDistanceFilter();
+
+  // The skeletonizer runs in place
+  ImageType::Pointer copy = copyImage(image);
+
+  SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+  skeletonizer->SetInput(copy);
+  skeletonizer->SetForegroundValue(255);
+  skeletonizer->SetMultiLabel(multiLabel);
+  skeletonizer->SetDistanceFilter(distanceFilter);
+  if(mode == Parallel)
+    {
+    skeletonizer->SetParallel(true);
+    skeletonizer->SetNumberOfThreads(4);
+    }
+  else if(mode == RuntimeCriteria)
+    {
+    skeletonizer->SetTerminalityCriterion(TerminalityType::New());
+    }
+  skeletonizer->Update();
+  return skeletonizer->GetOutput();
+  }
+
+
+/** Skeleton of each label thinned alone, the other labels being background */
+ImageType::Pointer skeletonizeLabels(ImageType const * labels,
+                                     unsigned char numberOfLabels, Mode mode)
+  {
+  ImageType::Pointer result = ImageType::New();
+  result->SetRegions(labels->GetBufferedRegion());
+  result->Allocate();
+  result->FillBuffer(0);
+
+  ImageType::Pointer object = ImageType::New();
+  object->SetRegions(labels->GetBufferedRegion());
+  object->Allocate();
+
+  for(unsigned char label = 1; label <= numberOfLabels; ++label)
+    {
+    itk::ImageRegionConstIterator<ImageType> labelsIt(
+      labels, labels->GetBufferedRegion());
+    itk::ImageRegionIterator<ImageType> objectIt(
+      object, object->GetBufferedRegion());
+    for(; !labelsIt.IsAtEnd(); ++labelsIt, ++objectIt)
+      {
+      objectIt.Set((labelsIt.Get() == label) ? 255 : 0);
+      }
+
+    ImageType::Pointer const skeleton = skeletonize(object, false, mode);
+    itk::ImageRegionConstIterator<ImageType> skeletonIt(
+      skeleton, skeleton->GetBufferedRegion());
+    itk::ImageRegionIterator<ImageType> resultIt(
+      result, result->GetBufferedRegion());
+    for(; !skeletonIt.IsAtEnd(); ++skeletonIt, ++resultIt)
+      {
+      if(skeletonIt.Get() == 255)
+        {
+        resultIt.Set(label);
+        }
+      }
+    }
+
+  return result;
+  }
+
+
+int main(int, char**)
+{
+  ImageType::Pointer labels = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill(40);
+  labels->SetRegions(size);
+  labels->Allocate();
+  labels->FillBuffer(0);
+
+  // Two blocks side by side, a slab lying on both, a bar touching the slab
+  // along an edge only, and a block of the same label as the bar, with a
+  // cavity filled by a fifth label.
+  setBox(labels, 3, 14, 3, 16, 3, 14, 1);
+  setBox(labels, 15, 26, 3, 16, 3, 14, 2);
+  setBox(labels, 3, 26, 3, 16, 15, 19, 3);
+  setBox(labels, 3, 36, 17, 20, 20, 23, 4);
+  setBox(labels, 25, 36, 24, 36, 3, 14, 4);
+  setBox(labels, 28, 33, 27, 33, 6, 11, 5);
+
+  unsigned int errors = 0;
+
+  char const * const names[] = { "sequential", "parallel",
+                                 "runtime criteria" };
+  Mode const modes[] = { Sequential, Parallel, RuntimeCriteria };
+  for(unsigned int i = 0; i < 3; ++i)
+    {
+    ImageType::Pointer const skeleton = skeletonize(labels, true, modes[i]);
+    ImageType::Pointer const expected =
+      skeletonizeLabels(labels, 5, modes[i]);
+    if(!sameImages(skeleton, expected))
+      {
+      std::cerr << "wrong " << names[i] << " skeleton" << std::endl;
+      ++errors;
+      }
+    errors += check(!sameImages(skeleton, labels), "labels not thinned");
+    }
+
+  // The criteria set at run time are not supported in parallel mode
+  bool thrown = false;
+  try
+    {
+    SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+    DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
+    skeletonizer->SetInput(labels);
+    skeletonizer->SetMultiLabel(true);
+    skeletonizer->SetParallel(true);
+    skeletonizer->SetDistanceFilter(distanceFilter);
+    skeletonizer->SetTerminalityCriterion(TerminalityType::New());
+    skeletonizer->Update();
+    }
+  catch(itk::ExceptionObject &)
+    {
+    thrown = true;
+    }
+  errors += check(thrown, "parallel multi-label with runtime criteria");
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,161 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <itkImage.h>
+
+#include "itkConnectivity.h"
+#include "itkPruneSkeletonImageFilter.h"
+
+typedef itk::Image<unsigned char, 3> ImageType;
+typedef itk::PruneSkeletonImageFilter<ImageType, itk::Connectivity<3, 0> >
+  FilterType;
+
+void setPoint(ImageType * image, long x, long y, long z)
+  {
+  ImageType::IndexType index;
+  index[0] = x;
+  index[1] = y;
+  index[2] = z;
+  image->SetPixel(index, 255);
+  }
+
+
+bool isSet(ImageType * image, long x, long y, long z)
+  {
+  ImageType::IndexType index;
+  index[0] = x;
+  index[1] = y;
+  index[2] = z;
+  return image->GetPixel(index) == 255;
+  }
+
+
+unsigned int check(bool condition, char const * message)
+  {
+  if(!condition)
+    {
+    std::cerr << message << std::endl;
+    return 1;
+    }
+  return 0;
+  }
+
+
+/** Skeleton of lines with spurs of various lengths. */
+ImageType::Pointer newSkeleton()
+  {
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill(40);
+  image->SetRegions(size);
+  image->Allocate();
+  image->FillBuffer(0);
+
+  // A line with spurs of 2, 3 and 8 points, and two opposite spurs of 2
+  // points at the same junction.
+  for(long x = 2; x < 38; ++x)
+    {
+    setPoint(image, x, 20, 20);
+    }
+  for(long i = 1; i <= 2; ++i)
+    {
+    setPoint(image, 8, 20+i, 20);
+    setPoint(image, 28, 20+i, 20);
+    setPoint(image, 28, 20-i, 20);
+    }
+  for(long i = 1; i <= 3; ++i)
+    {
+    setPoint(image, 14, 20, 20+i);
+    }
+  for(long i = 1; i <= 8; ++i)
+    {
+    setPoint(image, 20, 20-i, 20);
+    }
+
+  // A line on the border of the image, with a spur of 2 points in the border
+  // plane : the junction of the spur is on the border, near the start of the
+  // buffer.
+  for(long x = 2; x < 38; ++x)
+    {
+    setPoint(image, x, 0, 0);
+    }
+  setPoint(image, 10, 1, 0);
+  setPoint(image, 10, 2, 0);
+  return image;
+  }
+
+
+int main(int, char**)
+{
+  ImageType::Pointer image = newSkeleton();
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetForegroundValue(255);
+  filter->SetMinimumBranchLength(5);
+  filter->Update();
+  ImageType * output = filter->GetOutput();
+
+  unsigned int errors = 0;
+  errors += check(filter->GetNumberOfPrunedBranches() == 5,
+                  "wrong number of pruned branches");
+  errors += check(filter->GetNumberOfPrunedPoints() == 10,
+                  "wrong number of pruned points");
+
+  // The short spurs are removed, the long one and the line are kept
+  errors += check(!isSet(output, 8, 21, 20) && !isSet(output, 14, 20, 21) &&
+                  !isSet(output, 28, 21, 20) && !isSet(output, 28, 19, 20),
+                  "short spur kept");
+  bool line = true;
+  for(long x = 2; x < 38; ++x)
+    {
+    line = line && isSet(output, x, 20, 20);
+    }
+  errors += check(line, "point of the line removed");
+  errors += check(isSet(output, 20, 12, 20), "long spur removed");
+
+  // The junction on the border is kept
+  errors += check(!isSet(output, 10, 2, 0), "spur on the border kept");
+  bool borderLine = isSet(output, 10, 1, 0);
+  for(long x = 2; x < 38; ++x)
+    {
+    borderLine = borderLine && isSet(output, x, 0, 0);
+    }
+  errors += check(borderLine, "point of the line on the border removed");
+
+  // With the ordering, the spurs are compared with the radius at their
+  // junction, in units of the unit weight : the radius is 1 everywhere but
+  // at the junction of the long spur, where it is 10, so only the long spur
+  // is removed.
+  image = newSkeleton();
+  FilterType::OrderingImageType::Pointer ordering =
+    FilterType::OrderingImageType::New();
+  ordering->SetRegions(image->GetBufferedRegion());
+  ordering->Allocate();
+  ordering->FillBuffer(3);
+  FilterType::OrderingImageType::IndexType junction;
+  junction[0] = 20;
+  junction[1] = 19;
+  junction[2] = 20;
+  ordering->SetPixel(junction, 30);
+
+  filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetOrderingImage(ordering);
+  filter->SetForegroundValue(255);
+  filter->SetMinimumBranchLength(1);
+  filter->SetUnitWeight(3);
+  filter->Update();
+  output = filter->GetOutput();
+  errors += check(filter->GetNumberOfPrunedBranches() == 1 &&
+                  filter->GetNumberOfPrunedPoints() == 8 &&
+                  !isSet(output, 20, 12, 20) && isSet(output, 8, 22, 20),
+                  "wrong pruning relative to the radius");
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "itkConnectivity.h"
+#include "itkSimplePointLookupTable.h"
+#include "itkUnitCubeCCCounter.h"
+
+/**
+ * @brief Compare the simplicity read in the lookup table with the simplicity
+ * computed by UnitCubeCCCounter, for given configurations.
+ */
+template<typename TForegroundConnectivity>
+class Checker
+  {
+  public :
+    typedef typename itk::BackgroundConnectivity<TForegroundConnectivity>::Type
+      BackgroundConnectivity;
+    typedef itk::SimplePointLookupTable<TForegroundConnectivity> TableType;
+    typedef typename TableType::ConfigurationType ConfigurationType;
+
+    Checker()
+    : m_Errors(0)
+      {
+      }
+
+    void operator()(ConfigurationType configuration)
+      {
+      unsigned int const size = TableType::NeighborhoodSize;
+      unsigned int const middle = size/2;
+
+      char foreground[TableType::NeighborhoodSize];
+      char background[TableType::NeighborhoodSize];
+      ConfigurationType bit = 1;
+      for(unsigned int i=0; i<size; ++i)
+        {
+        if(i == middle)
+          {
+          foreground[i] = background[i] = 0;
+          continue;
+          }
+        foreground[i] = (configuration & bit) ? 255 : 0;
+        background[i] = 255 - foreground[i];
+        bit <<= 1;
+        }
+
+      bool const expected =
+        (m_ForegroundCounter(foreground) == 1 &&
+         m_BackgroundCounter(background) == 1);
+
+      if(TableType::GetInstance().IsSimple(configuration) != expected)
+        {
+        if(m_Errors < 10)
+          {
+          std::cerr << "Connectivity (" << TForegroundConnectivity::Dimension
+                    << ", " << TForegroundConnectivity::CellDimension
+                    << ") : mismatch for configuration " << configuration
+                    << std::endl;
+          }
+        ++m_Errors;
+        }
+      }
+
+    unsigned int GetErrors() const
+      {
+      return m_Errors;
+      }
+
+  private :
+    itk::UnitCubeCCCounter<TForegroundConnectivity> m_ForegroundCounter;
+    itk::UnitCubeCCCounter<BackgroundConnectivity> m_BackgroundCounter;
+    unsigned int m_Errors;
+  };
+
+
+template<typename TConnectivity>
+unsigned int checkAll()
+  {
+  typedef itk::SimplePointLookupTable<TConnectivity> TableType;
+  Checker<TConnectivity> checker;
+  for(typename TableType::ConfigurationType configuration = 0;
+      configuration < TableType::NumberOfConfigurations; ++configuration)
+    {
+    checker(configuration);
+    }
+  return checker.GetErrors();
+  }
+
+
+template<typename TConnectivity>
+unsigned int checkSample(unsigned int samples)
+  {
+  typedef itk::SimplePointLookupTable<TConnectivity> TableType;
+  typedef typename TableType::ConfigurationType ConfigurationType;
+
+  Checker<TConnectivity> checker;
+  std::srand(0);
+  for(unsigned int sample=0; sample<samples; ++sample)
+    {
+    // Vary the density, so that configurations with few or many foreground
+    // points (where most simple points are) get tested.
+    int const density = sample % 9 + 1;
+    ConfigurationType configuration = 0;
+    for(unsigned int i=0; i<TableType::NumberOfBits; ++i)
+      {
+      if(std::rand() % 10 < density)
+        {
+        configuration |= ConfigurationType(1) << i;
+        }
+      }
+    checker(configuration);
+    }
+  return checker.GetErrors();
+  }
+
+
+int main(int, char**)
+{
+  unsigned int errors = 0;
+
+  errors += checkAll<itk::Connectivity<2, 0> >();
+  errors += checkAll<itk::Connectivity<2, 1> >();
+
+  errors += checkSample<itk::Connectivity<3, 0> >(5000);
+  errors += checkSample<itk::Connectivity<3, 1> >(5000);
+  errors += checkSample<itk::Connectivity<3, 2> >(5000);
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
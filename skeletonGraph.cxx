@@ -0,0 +1,209 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <itkImage.h>
+
+#include "itkConnectivity.h"
+#include "itkSkeletonToGraphFilter.h"
+
+typedef itk::Image<unsigned char, 3> ImageType;
+typedef itk::SkeletonToGraphFilter<ImageType, itk::Connectivity<3, 0> >
+  FilterType;
+typedef FilterType::GraphType GraphType;
+
+void setPoint(ImageType * image, long x, long y, long z)
+  {
+  ImageType::IndexType index;
+  index[0] = x;
+  index[1] = y;
+  index[2] = z;
+  image->SetPixel(index, 255);
+  }
+
+
+unsigned int check(bool condition, char const * message)
+  {
+  if(!condition)
+    {
+    std::cerr << message << std::endl;
+    return 1;
+    }
+  return 0;
+  }
+
+
+int main(int, char**)
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill(32);
+  image->SetRegions(size);
+  image->Allocate();
+  image->FillBuffer(0);
+
+  // A Y with three branches of 5 steps from the junction at (10, 10, 10),
+  // two of them diagonal so that the first points of the branches are not
+  // neighbors.
+  setPoint(image, 10, 10, 10);
+  for(long i = 1; i <= 5; ++i)
+    {
+    setPoint(image, 10+i, 10+i, 10);
+    setPoint(image, 10-i, 10+i, 10);
+    setPoint(image, 10, 10-i, 10);
+    }
+
+  // A closed curve of 8 diagonal steps in the plane z = 25
+  long const curve[8][2] =
+    { {2, 0}, {1, 1}, {0, 2}, {-1, 1}, {-2, 0}, {-1, -1}, {0, -2}, {1, -1} };
+  for(unsigned int i = 0; i < 8; ++i)
+    {
+    setPoint(image, 20+curve[i][0], 20+curve[i][1], 25);
+    }
+
+  // An isolated point
+  setPoint(image, 25, 5, 5);
+
+  // A crossing of 4 branches of 4 steps in the plane z = 15 : the center and
+  // the first points of the branches are neighbors, and make one junction.
+  setPoint(image, 22, 8, 15);
+  for(long i = 1; i <= 4; ++i)
+    {
+    setPoint(image, 22+i, 8, 15);
+    setPoint(image, 22-i, 8, 15);
+    setPoint(image, 22, 8+i, 15);
+    setPoint(image, 22, 8-i, 15);
+    }
+
+  // A T in the plane z = 20 : a bar from x = 4 to 14, and a stem of 6
+  // points from its middle. The 4 points where they meet are one junction.
+  for(long x = 4; x <= 14; ++x)
+    {
+    setPoint(image, x, 25, 20);
+    }
+  for(long y = 19; y <= 24; ++y)
+    {
+    setPoint(image, 9, y, 20);
+    }
+
+  // A junction at (5, 26, 8) with two branches of 3 diagonal steps, and a
+  // spur of a single point touching the junction only : the spur is an end
+  // point of its own, linked to the junction by an edge without points.
+  setPoint(image, 5, 26, 8);
+  setPoint(image, 6, 25, 7);
+  for(long i = 1; i <= 3; ++i)
+    {
+    setPoint(image, 5+i, 26+i, 8+i);
+    setPoint(image, 5-i, 26-i, 8+i);
+    }
+
+  // A segment of two points : two end points and an edge without points
+  setPoint(image, 28, 28, 3);
+  setPoint(image, 29, 28, 3);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetForegroundValue(255);
+  filter->Update();
+  GraphType const * graph = filter->GetOutput();
+
+  unsigned int errors = 0;
+  errors += check(graph->GetNumberOfNodes() == 21, "wrong number of nodes");
+  errors += check(graph->GetNumberOfEdges() == 15, "wrong number of edges");
+
+  unsigned int endPoints = 0;
+  unsigned int junctions = 0;
+  unsigned int crossings = 0;
+  unsigned int isolated = 0;
+  for(unsigned long i = 0; i < graph->GetNumberOfNodes(); ++i)
+    {
+    GraphType::Node const & node = graph->GetNode(i);
+    endPoints += (node.Degree == 1);
+    junctions += (node.Degree == 3);
+    isolated += (node.Degree == 0);
+    if(node.Degree == 4)
+      {
+      ++crossings;
+      errors += check(node.Index[0] == 22 && node.Index[1] == 8 &&
+                      node.Index[2] == 15, "wrong point of the crossing");
+      }
+    if(node.Degree == 3 && node.Index[2] == 20)
+      {
+      errors += check(node.Index[0] == 9 && node.Index[1] == 25,
+                      "wrong point of the T junction");
+      }
+    if(node.Degree == 3 && node.Index[2] == 8)
+      {
+      errors += check(node.Index[0] == 5 && node.Index[1] == 26,
+                      "wrong point of the spur junction");
+      }
+    }
+  errors += check(endPoints == 15 && junctions == 3 && crossings == 1 &&
+                  isolated == 1, "wrong degrees of the nodes");
+
+  // The branches of the Y have 4 points and a length of 5 or 5*sqrt(2),
+  // those of the crossing 2 points and a length of 3, those of the bar of
+  // the T 3 points and a length of 4, the stem 4 points and a length of 5.
+  // The branches next to the spur have 2 points and a length of 3*sqrt(3),
+  // the spur and the segment no points and a length of sqrt(3) and 1.
+  unsigned int straightBranches = 0;
+  unsigned int diagonalBranches = 0;
+  unsigned int crossingBranches = 0;
+  unsigned int barBranches = 0;
+  unsigned int spurBranches = 0;
+  unsigned int spurs = 0;
+  unsigned int segments = 0;
+  unsigned int loops = 0;
+  for(unsigned long i = 0; i < graph->GetNumberOfEdges(); ++i)
+    {
+    GraphType::Edge const & edge = graph->GetEdge(i);
+    unsigned long const points = edge.Points.size();
+    if(edge.Source == edge.Target)
+      {
+      ++loops;
+      errors += check(points == 7, "wrong points of the loop");
+      errors += check(std::fabs(edge.Length - 8*std::sqrt(2.)) < 1e-9,
+                      "wrong length of the loop");
+      }
+    else if(points == 4 && std::fabs(edge.Length - 5) < 1e-9)
+      {
+      ++straightBranches;
+      }
+    else if(points == 4 && std::fabs(edge.Length - 5*std::sqrt(2.)) < 1e-9)
+      {
+      ++diagonalBranches;
+      }
+    else if(points == 2 && std::fabs(edge.Length - 3) < 1e-9)
+      {
+      ++crossingBranches;
+      }
+    else if(points == 3 && std::fabs(edge.Length - 4) < 1e-9)
+      {
+      ++barBranches;
+      }
+    else if(points == 2 && std::fabs(edge.Length - 3*std::sqrt(3.)) < 1e-9)
+      {
+      ++spurBranches;
+      }
+    else if(points == 0 && std::fabs(edge.Length - std::sqrt(3.)) < 1e-9)
+      {
+      ++spurs;
+      }
+    else if(points == 0 && std::fabs(edge.Length - 1) < 1e-9)
+      {
+      ++segments;
+      }
+    }
+  errors += check(straightBranches == 2 && diagonalBranches == 2 &&
+                  crossingBranches == 4 && barBranches == 2 &&
+                  spurBranches == 2 && spurs == 1 && segments == 1 &&
+                  loops == 1, "wrong edges");
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
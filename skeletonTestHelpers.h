@@ -0,0 +1,99 @@
+#ifndef skeletonTestHelpers_h
+#define skeletonTestHelpers_h
+
+#include <iostream>
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+
+#include "itkChamferDistanceTransformImageFilter.h"
+
+/**
+ * @name Helpers shared by the skeletonization tests
+ *
+ * The tests thin objects of foreground 255 in 3D images, ordered by the
+ * chamfer distance in the object.
+ */
+//@{
+typedef itk::Image<unsigned char, 3> ImageType;
+typedef itk::Image<unsigned int, 3> OrderingImageType;
+typedef itk::ChamferDistanceTransformImageFilter<ImageType, OrderingImageType>
+  DistanceFilterType;
+
+/** Set the points of a box, bounds included, to value. */
+inline void setBox(ImageType * image, long x0, long x1, long y0, long y1,
+                   long z0, long z1, unsigned char value)
+  {
+  ImageType::IndexType index;
+  for(index[2] = z0; index[2] <= z1; ++index[2])
+    {
+    for(index[1] = y0; index[1] <= y1; ++index[1])
+      {
+      for(index[0] = x0; index[0] <= x1; ++index[0])
+        {
+        image->SetPixel(index, value);
+        }
+      }
+    }
+  }
+
+
+/** Copy of an image, e.g. the input of a skeletonizer, which runs in place.*/
+inline ImageType::Pointer copyImage(ImageType const * image)
+  {
+  ImageType::Pointer copy = ImageType::New();
+  copy->SetRegions(image->GetBufferedRegion());
+  copy->Allocate();
+  itk::ImageRegionConstIterator<ImageType> imageIt(
+    image, image->GetBufferedRegion());
+  itk::ImageRegionIterator<ImageType> copyIt(copy, copy->GetBufferedRegion());
+  for(; !imageIt.IsAtEnd(); ++imageIt, ++copyIt)
+    {
+    copyIt.Set(imageIt.Get());
+    }
+  return copy;
+  }
+
+
+inline bool sameImages(ImageType const * image1, ImageType const * image2)
+  {
+  itk::ImageRegionConstIterator<ImageType> it1(image1,
+                                               image1->GetBufferedRegion());
+  itk::ImageRegionConstIterator<ImageType> it2(image2,
+                                               image2->GetBufferedRegion());
+  for(; !it1.IsAtEnd(); ++it1, ++it2)
+    {
+    if(it1.Get() != it2.Get())
+      {
+      return false;
+      }
+    }
+  return true;
+  }
+
+
+/** Distance filter in the object, with the (3, 4, 5) weights. */
+inline DistanceFilterType::Pointer newDistanceFilter()
+  {
+  DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
+  unsigned int weights[] = { 3, 4, 5 };
+  distanceFilter->SetDistanceFromObject(false);
+  distanceFilter->SetWeights(weights, weights+3);
+  distanceFilter->SetForegroundValue(255);
+  return distanceFilter;
+  }
+
+
+inline unsigned int check(bool condition, char const * message)
+  {
+  if(!condition)
+    {
+    std::cerr << message << std::endl;
+    return 1;
+    }
+  return 0;
+  }
+//@}
+
+#endif // skeletonTestHelpers_h
@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkTimeProbe.h>
+
+#include "itkChamferDistanceTransformImageFilter.h"
+#include "itkConnectivity.h"
+#include "itkHierarchicalQueue.h"
+#include "itkSkeletonizeImageFilter.h"
+
+/**
+ * @brief Benchmark of the skeletonization pipeline on synthetic inputs.
+ *
+ * For each shape and size, the chamfer distance transform is timed once,
+ * then the skeletonization for each foreground connectivity, then the
+ * filling and draining of each type of hierarchical queue with the ordering
+ * image. The 26-connected skeletonization is also run on a 16 bits ordering,
+ * saturated by the chamfer filter, which selects the vector queue, and with
+ * the sparse initialization of the queue. The results are written as CSV,
+ * one line per measure. The count is the peak size of the queue for the
+ * initialization, the number of points popped for the thinning and the
+ * queues, and the number of points of the skeleton for the whole
+ * skeletonization.
+ */
+
+const unsigned int Dimension = 3;
+typedef itk::Image<unsigned char, Dimension> ImageType;
+typedef itk::SkeletonizeImageFilter<ImageType, itk::Connectivity<Dimension, 0> >
+  DefaultSkeletonizerType;
+typedef DefaultSkeletonizerType::OrderingImageType OrderingImageType;
+typedef itk::ChamferDistanceTransformImageFilter<ImageType, OrderingImageType>
+  DistanceMapFilterType;
+typedef itk::Image<unsigned short, Dimension> ShortOrderingImageType;
+typedef itk::ChamferDistanceTransformImageFilter<ImageType,
+                                                 ShortOrderingImageType>
+  ShortDistanceMapFilterType;
+
+unsigned char const ForegroundValue = 255;
+unsigned char const BackgroundValue = 0;
+
+/** @brief Options of the command line. */
+struct Options
+  {
+  std::vector<unsigned int> Sizes;
+  std::string Bunny;
+  std::string Output;
+  bool Parallel;
+  };
+
+
+/** @brief Create an empty image of size^3 voxels. */
+ImageType::Pointer CreateImage(ImageType::SizeType const & size)
+  {
+  ImageType::Pointer image = ImageType::New();
+  ImageType::RegionType region;
+  region.SetSize(size);
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(BackgroundValue);
+  return image;
+  }
+
+
+/** @brief Copy an image, the skeletonization being done in place. */
+ImageType::Pointer Duplicate(ImageType const * image)
+  {
+  ImageType::Pointer copy = CreateImage(image->GetBufferedRegion().GetSize());
+  std::copy(image->GetBufferPointer(),
+            image->GetBufferPointer() +
+              image->GetBufferedRegion().GetNumberOfPixels(),
+            copy->GetBufferPointer());
+  return copy;
+  }
+
+
+/** @brief Square of the distance from p to the segment [a, b]. */
+double SquaredDistanceToSegment(double const * p, double const * a,
+                                double const * b)
+  {
+  double ab2 = 0, t = 0;
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    ab2 += (b[i]-a[i])*(b[i]-a[i]);
+    t += (p[i]-a[i])*(b[i]-a[i]);
+    }
+  t = (ab2 > 0) ? std::max(0., std::min(1., t/ab2)) : 0;
+
+  double d2 = 0;
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    double const x = a[i] + t*(b[i]-a[i]) - p[i];
+    d2 += x*x;
+    }
+  return d2;
+  }
+
+
+/** @brief Draw a cylinder with spherical caps between a and b. */
+void DrawSegment(ImageType * image, double const * a, double const * b,
+                 double radius)
+  {
+  ImageType::RegionType const region = image->GetBufferedRegion();
+  ImageType::IndexType begin, end;
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    // Keep the border of the image empty
+    begin[i] = std::max(1L, long(std::floor(std::min(a[i], b[i])-radius)));
+    end[i] = std::min(long(region.GetSize()[i])-1,
+                      long(std::ceil(std::max(a[i], b[i])+radius))+1);
+    if(begin[i] >= end[i])
+      {
+      return;
+      }
+    }
+
+  ImageType::SizeType size;
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    size[i] = end[i]-begin[i];
+    }
+  ImageType::RegionType box;
+  box.SetIndex(begin);
+  box.SetSize(size);
+
+  for(itk::ImageRegionIteratorWithIndex<ImageType> it(image, box);
+      !it.IsAtEnd(); ++it)
+    {
+    double p[Dimension];
+    for(unsigned int i=0; i<Dimension; ++i)
+      {
+      p[i] = it.GetIndex()[i];
+      }
+    if(SquaredDistanceToSegment(p, a, b) <= radius*radius)
+      {
+      it.Set(ForegroundValue);
+      }
+    }
+  }
+
+
+/** @brief Ball of radius 0.4*size. */
+ImageType::Pointer CreateBall(unsigned int size)
+  {
+  ImageType::SizeType imageSize;
+  imageSize.Fill(size);
+  ImageType::Pointer image = CreateImage(imageSize);
+  double const center[Dimension] = { size/2., size/2., size/2. };
+  DrawSegment(image, center, center, 0.4*size);
+  return image;
+  }
+
+
+/** @brief Torus, i.e. a closed tube, of radii 0.3*size and 0.08*size. */
+ImageType::Pointer CreateTube(unsigned int size)
+  {
+  ImageType::SizeType imageSize;
+  imageSize.Fill(size);
+  ImageType::Pointer image = CreateImage(imageSize);
+
+  unsigned int const segments = 64;
+  double const pi = 3.14159265358979323846;
+  for(unsigned int i=0; i<segments; ++i)
+    {
+    double const alpha = 2*pi*i/segments;
+    double const beta = 2*pi*(i+1)/segments;
+    double const a[Dimension] = { size/2. + 0.3*size*std::cos(alpha),
+                                  size/2. + 0.3*size*std::sin(alpha),
+                                  size/2. };
+    double const b[Dimension] = { size/2. + 0.3*size*std::cos(beta),
+                                  size/2. + 0.3*size*std::sin(beta),
+                                  size/2. };
+    DrawSegment(image, a, b, 0.08*size);
+    }
+  return image;
+  }
+
+
+/** @brief Binary tree of tapering branches, each forking in two. */
+void DrawBranch(ImageType * image, double const * origin,
+                double const * direction, double length, double radius,
+                unsigned int depth)
+  {
+  double end[Dimension];
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    end[i] = origin[i] + length*direction[i];
+    }
+  DrawSegment(image, origin, end, radius);
+
+  if(depth == 0)
+    {
+    return;
+    }
+
+  // Children are rotated by +/- 35 degrees around an axis alternating with
+  // the depth, so that the tree spans the three dimensions.
+  double const angle = 0.61;
+  unsigned int const axis = depth % 2;
+  for(int side=-1; side<=1; side+=2)
+    {
+    double const c = std::cos(side*angle), s = std::sin(side*angle);
+    double child[Dimension];
+    std::copy(direction, direction+Dimension, child);
+    unsigned int const u = (axis == 0) ? 0 : 1;
+    unsigned int const v = 2;
+    child[u] = c*direction[u] - s*direction[v];
+    child[v] = s*direction[u] + c*direction[v];
+    DrawBranch(image, end, child, 0.75*length, 0.7*radius, depth-1);
+    }
+  }
+
+
+/** @brief Vessel-like tree rising from the bottom of the image. */
+ImageType::Pointer CreateTree(unsigned int size)
+  {
+  ImageType::SizeType imageSize;
+  imageSize.Fill(size);
+  ImageType::Pointer image = CreateImage(imageSize);
+  double const origin[Dimension] = { size/2., size/2., 0.05*size };
+  double const direction[Dimension] = { 0, 0, 1 };
+  DrawBranch(image, origin, direction, 0.25*size, 0.05*size, 6);
+  return image;
+  }
+
+
+/**
+ * @brief Nearest neighbor upscaling of an image, so that its largest side
+ * has size voxels.
+ */
+ImageType::Pointer CreateUpscaled(ImageType const * input, unsigned int size)
+  {
+  ImageType::SizeType const & inputSize =
+    input->GetLargestPossibleRegion().GetSize();
+  unsigned long largest = 0;
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    largest = std::max<unsigned long>(largest, inputSize[i]);
+    }
+  double const scale = double(size)/largest;
+
+  ImageType::SizeType imageSize;
+  for(unsigned int i=0; i<Dimension; ++i)
+    {
+    imageSize[i] = std::max(1UL,
+                            static_cast<unsigned long>(inputSize[i]*scale));
+    }
+  ImageType::Pointer image = CreateImage(imageSize);
+
+  ImageType::IndexType const inputStart =
+    input->GetLargestPossibleRegion().GetIndex();
+  for(itk::ImageRegionIteratorWithIndex<ImageType>
+        it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType index;
+    for(unsigned int i=0; i<Dimension; ++i)
+      {
+      index[i] = inputStart[i] + std::min<long>(
+        static_cast<long>(it.GetIndex()[i]/scale), inputSize[i]-1);
+      }
+    it.Set(input->GetPixel(index) != BackgroundValue ?
+           ForegroundValue : BackgroundValue);
+    }
+  return image;
+  }
+
+
+/** @brief Number of voxels of an image having the foreground value. */
+unsigned long CountForeground(ImageType const * image)
+  {
+  unsigned char const * const begin = image->GetBufferPointer();
+  unsigned char const * const end =
+    begin + image->GetBufferedRegion().GetNumberOfPixels();
+  return std::count(begin, end, ForegroundValue);
+  }
+
+
+/** @brief Output of the measures. */
+class Report
+  {
+  public :
+    Report(std::ostream & stream)
+    : m_Stream(stream)
+      {
+      m_Stream << "shape,size,connectivity,mode,queue,phase,seconds,"
+               << "foreground,count" << std::endl;
+      }
+
+    void SetCase(std::string const & shape, unsigned int size,
+                 unsigned long foreground)
+      {
+      m_Shape = shape;
+      m_Size = size;
+      m_Foreground = foreground;
+      }
+
+    void Write(std::string const & connectivity, std::string const & mode,
+               std::string const & queue, std::string const & phase,
+               double seconds, unsigned long count=0)
+      {
+      m_Stream << m_Shape << "," << m_Size << "," << connectivity << ","
+               << mode << "," << queue << "," << phase << "," << seconds
+               << "," << m_Foreground << "," << count << std::endl;
+      }
+
+  private :
+    std::ostream & m_Stream;
+    std::string m_Shape;
+    unsigned int m_Size;
+    unsigned long m_Foreground;
+  };
+
+
+template<typename TConnectivity, typename TOrderingImage>
+void BenchmarkSkeletonization(ImageType const * image,
+                              TOrderingImage * ordering,
+                              std::string const & connectivity,
+                              std::string const & queue, bool parallel,
+                              bool sparse, Report & report)
+  {
+  typedef itk::SkeletonizeImageFilter<ImageType, TConnectivity,
+                                      TOrderingImage> SkeletonizerType;
+
+  typename SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+  skeletonizer->SetInput(Duplicate(image));
+  skeletonizer->SetOrderingImage(ordering);
+  skeletonizer->SetForegroundValue(ForegroundValue);
+  skeletonizer->SetBackgroundValue(BackgroundValue);
+  skeletonizer->SetParallel(parallel);
+  skeletonizer->SetSparseInitialization(sparse);
+  skeletonizer->CollectStatisticsOn();
+
+  itk::TimeProbe probe;
+  probe.Start();
+  skeletonizer->Update();
+  probe.Stop();
+
+  std::string mode = parallel ? "parallel" : "sequential";
+  if(sparse)
+    {
+    mode += "_sparse";
+    }
+  report.Write(connectivity, mode, queue, "initialization",
+               skeletonizer->GetInitializationTime(),
+               skeletonizer->GetPeakQueueSize());
+  report.Write(connectivity, mode, queue, "thinning",
+               skeletonizer->GetThinningTime(),
+               skeletonizer->GetNumberOfPops());
+  report.Write(connectivity, mode, queue, "skeletonization",
+               probe.GetMeanTime(),
+               CountForeground(skeletonizer->GetOutput()));
+  }
+
+
+/**
+ * @brief Fill a queue with the points of non-null ordering in raster order,
+ * as the skeletonization does, then drain it.
+ */
+template<typename TQueue>
+void BenchmarkQueue(OrderingImageType const * ordering,
+                    std::string const & queueName, Report & report)
+  {
+  typedef typename TQueue::KeyType KeyType;
+  OrderingImageType::PixelType const * const buffer =
+    ordering->GetBufferPointer();
+  unsigned long const size = ordering->GetBufferedRegion().GetNumberOfPixels();
+
+  TQueue queue;
+  itk::TimeProbe pushProbe;
+  pushProbe.Start();
+  for(unsigned long i=0; i<size; ++i)
+    {
+    if(buffer[i] != 0)
+      {
+      queue.Push(static_cast<KeyType>(buffer[i]), i);
+      }
+    }
+  pushProbe.Stop();
+
+  itk::TimeProbe popProbe;
+  popProbe.Start();
+  unsigned long count = 0;
+  while(!queue.Empty())
+    {
+    queue.Pop();
+    ++count;
+    }
+  popProbe.Stop();
+
+  report.Write("-", "-", queueName, "queue_push", pushProbe.GetMeanTime());
+  report.Write("-", "-", queueName, "queue_pop", popProbe.GetMeanTime(),
+               count);
+  }
+
+
+void Benchmark(std::string const & shape, unsigned int size,
+               ImageType * image, Options const & options, Report & report)
+  {
+  report.SetCase(shape, size, CountForeground(image));
+
+  DistanceMapFilterType::Pointer distanceMapFilter =
+    DistanceMapFilterType::New();
+  unsigned int weights[] = { 3, 4, 5 };
+  distanceMapFilter->SetDistanceFromObject(false);
+  distanceMapFilter->SetWeights(weights, weights+3);
+  distanceMapFilter->SetInput(image);
+  distanceMapFilter->SetForegroundValue(ForegroundValue);
+
+  itk::TimeProbe probe;
+  probe.Start();
+  distanceMapFilter->Update();
+  probe.Stop();
+  report.Write("-", "-", "-", "chamfer", probe.GetMeanTime());
+
+  OrderingImageType::Pointer ordering = distanceMapFilter->GetOutput();
+
+  ShortDistanceMapFilterType::Pointer shortDistanceMapFilter =
+    ShortDistanceMapFilterType::New();
+  shortDistanceMapFilter->SetDistanceFromObject(false);
+  shortDistanceMapFilter->SetWeights(weights, weights+3);
+  shortDistanceMapFilter->SetInput(image);
+  shortDistanceMapFilter->SetForegroundValue(ForegroundValue);
+
+  itk::TimeProbe shortProbe;
+  shortProbe.Start();
+  shortDistanceMapFilter->Update();
+  shortProbe.Stop();
+  report.Write("-", "-", "vector", "chamfer", shortProbe.GetMeanTime());
+
+  ShortOrderingImageType::Pointer shortOrdering =
+    shortDistanceMapFilter->GetOutput();
+
+  for(unsigned int mode=0; mode<(options.Parallel ? 2 : 1); ++mode)
+    {
+    BenchmarkSkeletonization<itk::Connectivity<3, 0> >(
+      image, ordering.GetPointer(), "26", "default", mode==1, false, report);
+    BenchmarkSkeletonization<itk::Connectivity<3, 1> >(
+      image, ordering.GetPointer(), "18", "default", mode==1, false, report);
+    BenchmarkSkeletonization<itk::Connectivity<3, 2> >(
+      image, ordering.GetPointer(), "6", "default", mode==1, false, report);
+    BenchmarkSkeletonization<itk::Connectivity<3, 0> >(
+      image, shortOrdering.GetPointer(), "26", "vector", mode==1, false,
+      report);
+    BenchmarkSkeletonization<itk::Connectivity<3, 0> >(
+      image, ordering.GetPointer(), "26", "default", mode==1, true, report);
+    }
+
+  typedef OrderingImageType::OffsetValueType OffsetValueType;
+  BenchmarkQueue<itk::HierarchicalQueue<unsigned long, OffsetValueType> >(
+    ordering, "map", report);
+  BenchmarkQueue<itk::BucketHierarchicalQueue<unsigned int, OffsetValueType,
+                                              std::less<unsigned int> > >(
+    ordering, "bucket", report);
+
+  OrderingImageType::PixelType const * const buffer =
+    ordering->GetBufferPointer();
+  if(*std::max_element(buffer,
+       buffer+ordering->GetBufferedRegion().GetNumberOfPixels()) <=
+     itk::NumericTraits<unsigned short>::max())
+    {
+    BenchmarkQueue<itk::VectorHierarchicalQueue<unsigned short,
+      OffsetValueType, std::less<unsigned short> > >(ordering, "vector",
+                                                    report);
+    }
+  }
+
+
+int main(int argc, char** argv)
+{
+  Options options;
+  options.Parallel = false;
+  for(int i=1; i<argc; ++i)
+    {
+    std::string const argument = argv[i];
+    if(argument == "-s" && i+1<argc)
+      {
+      std::istringstream sizes(argv[++i]);
+      std::string size;
+      while(std::getline(sizes, size, ','))
+        {
+        options.Sizes.push_back(std::atoi(size.c_str()));
+        }
+      }
+    else if(argument == "-b" && i+1<argc)
+      {
+      options.Bunny = argv[++i];
+      }
+    else if(argument == "-o" && i+1<argc)
+      {
+      options.Output = argv[++i];
+      }
+    else if(argument == "-p")
+      {
+      options.Parallel = true;
+      }
+    else
+      {
+      std::cerr << "usage: " << argv[0]
+                << " [-s size,...] [-b bunnyPadded.nrrd] [-o results.csv] [-p]"
+                << "\n"
+                << "  -s : sizes of the images, default 64,128,256 (up to 1024)"
+                << "\n"
+                << "  -b : also upscale and skeletonize this image" << "\n"
+                << "  -o : write the results to this file instead of stdout"
+                << "\n"
+                << "  -p : also run the parallel mode" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if(options.Sizes.empty())
+    {
+    options.Sizes.push_back(64);
+    options.Sizes.push_back(128);
+    options.Sizes.push_back(256);
+    }
+
+  std::ofstream file;
+  if(!options.Output.empty())
+    {
+    file.open(options.Output.c_str());
+    if(!file)
+      {
+      std::cerr << "Cannot open " << options.Output << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  Report report(options.Output.empty() ? std::cout : file);
+
+  ImageType::Pointer bunny;
+  if(!options.Bunny.empty())
+    {
+    itk::ImageFileReader<ImageType>::Pointer reader =
+      itk::ImageFileReader<ImageType>::New();
+    reader->SetFileName(options.Bunny.c_str());
+    reader->Update();
+    bunny = reader->GetOutput();
+    }
+
+  for(unsigned int i=0; i<options.Sizes.size(); ++i)
+    {
+    unsigned int const size = options.Sizes[i];
+    Benchmark("ball", size, CreateBall(size), options, report);
+    Benchmark("tube", size, CreateTube(size), options, report);
+    Benchmark("tree", size, CreateTree(size), options, report);
+    if(bunny)
+      {
+      Benchmark("bunny", size, CreateUpscaled(bunny, size), options, report);
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <itkImage.h>
+
+#include "itkConnectivity.h"
+#include "itkSkeletonizeImageFilter.h"
+#include "skeletonTestHelpers.h"
+
+typedef itk::SkeletonizeImageFilter<ImageType, itk::Connectivity<3, 0> >
+  SkeletonizerType;
+
+void setBall(ImageType * image, long x, long y, long z)
+  {
+  ImageType::IndexType index;
+  for(index[2] = z-4; index[2] <= z+4; ++index[2])
+    {
+    for(index[1] = y-4; index[1] <= y+4; ++index[1])
+      {
+      for(index[0] = x-4; index[0] <= x+4; ++index[0])
+        {
+        long const dx = index[0]-x;
+        long const dy = index[1]-y;
+        long const dz = index[2]-z;
+        if(dx*dx + dy*dy + dz*dz <= 20)
+          {
+          image->SetPixel(index, 255);
+          }
+        }
+      }
+    }
+  }
+
+
+/**
+ * Skeleton of the object, ordered by the ordering image if it is not null,
+ * and by a distance filter otherwise. The number of points popped from the
+ * queue is stored in pops.
+ */
+ImageType::Pointer skeletonize(ImageType * object,
+                               OrderingImageType * ordering,
+                               bool sparseInitialization,
+                               unsigned long & pops)
+  {
+  // The skeletonizer runs in place
+  ImageType::Pointer copy = copyImage(object);
+
+  SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+  skeletonizer->SetInput(copy);
+  skeletonizer->SetForegroundValue(255);
+  if(ordering)
+    {
+    skeletonizer->SetOrderingImage(ordering);
+    }
+  else
+    {
+    skeletonizer->SetDistanceFilter(newDistanceFilter());
+    }
+  skeletonizer->SetSparseInitialization(sparseInitialization);
+  skeletonizer->CollectStatisticsOn();
+  skeletonizer->Update();
+  pops = skeletonizer->GetNumberOfPops();
+  return skeletonizer->GetOutput();
+  }
+
+
+int main(int, char**)
+{
+  ImageType::Pointer object = ImageType::New();
+  ImageType::SizeType size;
+  size.Fill(64);
+  object->SetRegions(size);
+  object->Allocate();
+  object->FillBuffer(0);
+
+  // A tree of thin branches : a trunk, levels of 4 branches ending in balls,
+  // and a comb at the top. The balls at both ends of a branch, and the teeth
+  // of the comb, make several runs on the lines along the first axis.
+  setBox(object, 30, 34, 30, 34, 4, 52, 255);
+  for(long z = 14; z <= 38; z += 12)
+    {
+    setBox(object, 10, 54, 30, 34, z, z+3, 255);
+    setBall(object, 8, 32, z+1);
+    setBall(object, 56, 32, z+1);
+    setBox(object, 30, 34, 10, 54, z+5, z+8, 255);
+    setBall(object, 32, 8, z+6);
+    setBall(object, 32, 56, z+6);
+    }
+  setBox(object, 8, 56, 30, 34, 53, 56, 255);
+  for(long x = 8; x <= 54; x += 6)
+    {
+    setBox(object, x, x+2, 12, 52, 57, 59, 255);
+    }
+
+  DistanceFilterType::Pointer distanceFilter = newDistanceFilter();
+  distanceFilter->SetInput(object);
+  distanceFilter->Update();
+  OrderingImageType::Pointer ordering = distanceFilter->GetOutput();
+
+  unsigned long densePops;
+  unsigned long sparsePops;
+  unsigned long listedPops;
+  ImageType::Pointer const dense =
+    skeletonize(object, ordering, false, densePops);
+  ImageType::Pointer const sparse =
+    skeletonize(object, ordering, true, sparsePops);
+  ImageType::Pointer const listed = skeletonize(object, 0, false, listedPops);
+
+  // A wrong flag of the queued points may leave the skeleton as is, but
+  // changes the points popped from the queue.
+  unsigned int errors = 0;
+  errors += check(!sameImages(dense, object), "object not thinned");
+  errors += check(sameImages(sparse, dense) && sparsePops == densePops,
+                  "different thinning with the sparse initialization");
+  errors += check(sameImages(listed, dense) && listedPops == densePops,
+                  "different thinning with the listed points");
+
+  // The distance filter is run by the skeletonizer, and a change of its
+  // parameters must bring the skeletonizer out of date.
+  SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+  DistanceFilterType::Pointer fusedFilter = newDistanceFilter();
+  skeletonizer->SetDistanceFilter(fusedFilter);
+  unsigned long const mtime = skeletonizer->GetMTime();
+  fusedFilter->SetForegroundValue(254);
+  errors += check(skeletonizer->GetMTime() > mtime,
+                  "distance filter not in the modification time");
+
+  // The distance from the object would leave the object unthinned
+  bool thrown = false;
+  try
+    {
+    fusedFilter->SetForegroundValue(255);
+    fusedFilter->SetDistanceFromObject(true);
+    skeletonizer->SetInput(object);
+    skeletonizer->SetForegroundValue(255);
+    skeletonizer->Update();
+    }
+  catch(itk::ExceptionObject &)
+    {
+    thrown = true;
+    }
+  errors += check(thrown, "distance from the object");
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,228 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <itkImage.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include "itkConnectivity.h"
+#include "itkSimplicityByTopologicalNumbersImageFunction.h"
+#include "itkSkeletonizeImageFilter.h"
+#include "itkSurfaceTerminalityImageFunction.h"
+#include "skeletonTestHelpers.h"
+
+typedef itk::Connectivity<3, 0> ConnectivityType;
+typedef itk::SurfaceTerminalityImageFunction<ImageType, ConnectivityType>
+  TerminalityType;
+typedef itk::SkeletonizeImageFilter<
+  ImageType, ConnectivityType, itk::Image<unsigned int, 3>,
+  itk::SimplicityByTopologicalNumbersImageFunction<ImageType,
+                                                   ConnectivityType>,
+  TerminalityType> SkeletonizerType;
+
+ImageType::Pointer newImage()
+  {
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size;
+  size[0] = 40;
+  size[1] = 40;
+  size[2] = 24;
+  image->SetRegions(size);
+  image->Allocate();
+  image->FillBuffer(0);
+  return image;
+  }
+
+
+/** Medial surface of the object. */
+ImageType::Pointer skeletonize(ImageType * object)
+  {
+  DistanceFilterType::Pointer distanceFilter = newDistanceFilter();
+
+  // The skeletonizer runs in place
+  ImageType::Pointer copy = copyImage(object);
+
+  SkeletonizerType::Pointer skeletonizer = SkeletonizerType::New();
+  skeletonizer->SetInput(copy);
+  skeletonizer->SetForegroundValue(255);
+  skeletonizer->SetDistanceFilter(distanceFilter);
+  skeletonizer->Update();
+  return skeletonizer->GetOutput();
+  }
+
+
+/** Number of points of the object. */
+unsigned long countPoints(ImageType const * image)
+  {
+  unsigned long points = 0;
+  for(itk::ImageRegionConstIterator<ImageType> it(
+        image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    points += (it.Get() == 255);
+    }
+  return points;
+  }
+
+
+/** True if no cube of 2x2x2 points is in the object. */
+bool isThin(ImageType const * image)
+  {
+  ImageType::RegionType region = image->GetBufferedRegion();
+  ImageType::SizeType size = region.GetSize();
+  for(unsigned int j = 0; j < 3; ++j)
+    {
+    --size[j];
+    }
+  region.SetSize(size);
+  for(itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, region);
+      !it.IsAtEnd(); ++it)
+    {
+    unsigned int points = 0;
+    ImageType::OffsetType offset;
+    for(offset[2] = 0; offset[2] <= 1; ++offset[2])
+      {
+      for(offset[1] = 0; offset[1] <= 1; ++offset[1])
+        {
+        for(offset[0] = 0; offset[0] <= 1; ++offset[0])
+          {
+          points += (image->GetPixel(it.GetIndex() + offset) == 255);
+          }
+        }
+      }
+    if(points == 8)
+      {
+      return false;
+      }
+    }
+  return true;
+  }
+
+
+/**
+ * True if the batch evaluation, the evaluation at offset and the evaluation
+ * at index agree on all the points that are not on the border of the image.
+ */
+bool sameEvaluations(ImageType const * image)
+  {
+  TerminalityType::Pointer terminality = TerminalityType::New();
+  terminality->SetInputImage(image);
+  terminality->SetForegroundValue(255);
+
+  ImageType::RegionType const region = image->GetBufferedRegion();
+  std::vector<ImageType::IndexType> indices;
+  std::vector<ImageType::OffsetValueType> offsets;
+  for(itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, region);
+      !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType const index = it.GetIndex();
+    bool border = false;
+    for(unsigned int j = 0; j < 3; ++j)
+      {
+      border = border || index[j] == 0 ||
+        index[j] == static_cast<long>(region.GetSize()[j])-1;
+      }
+    if(!border)
+      {
+      indices.push_back(index);
+      offsets.push_back(image->ComputeOffset(index));
+      }
+    }
+
+  bool * results = new bool[offsets.size()];
+  terminality->EvaluateAtOffsets(&offsets[0], offsets.size(), results);
+  bool same = true;
+  for(unsigned long i = 0; i < offsets.size(); ++i)
+    {
+    bool const atIndex = terminality->EvaluateAtIndex(indices[i]);
+    same = same && results[i] == atIndex &&
+      terminality->EvaluateAtOffset(offsets[i]) == atIndex;
+    }
+  delete[] results;
+  return same;
+  }
+
+
+int main(int, char**)
+{
+  unsigned int errors = 0;
+
+  // A plate 7 points thick : its medial surface is the middle plane, away
+  // from the edges where the wings of the medial surface of a box start.
+  ImageType::Pointer plate = newImage();
+  for(itk::ImageRegionIteratorWithIndex<ImageType> it(
+        plate, plate->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    ImageType::IndexType const index = it.GetIndex();
+    if(index[0] >= 4 && index[0] <= 35 && index[1] >= 4 && index[1] <= 35 &&
+       index[2] >= 8 && index[2] <= 14)
+      {
+      it.Set(255);
+      }
+    }
+  ImageType::Pointer const plateSkeleton = skeletonize(plate);
+
+  bool sheet = true;
+  ImageType::IndexType index;
+  for(index[1] = 12; index[1] <= 27; ++index[1])
+    {
+    for(index[0] = 12; index[0] <= 27; ++index[0])
+      {
+      for(index[2] = 8; index[2] <= 14; ++index[2])
+        {
+        sheet = sheet &&
+          ((plateSkeleton->GetPixel(index) == 255) == (index[2] == 11));
+        }
+      }
+    }
+  errors += check(sheet, "wrong medial surface of the plate");
+  errors += check(isThin(plateSkeleton), "plate skeleton not thin");
+
+  // A ball : the balls of the chamfer distance are polyhedra, and the medial
+  // surface is made of the sheets under their edges, through the center.
+  ImageType::Pointer ball = newImage();
+  for(itk::ImageRegionIteratorWithIndex<ImageType> it(
+        ball, ball->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    long const x = it.GetIndex()[0]-20;
+    long const y = it.GetIndex()[1]-20;
+    long const z = it.GetIndex()[2]-12;
+    if(x*x + y*y + z*z <= 81)
+      {
+      it.Set(255);
+      }
+    }
+  ImageType::Pointer const ballSkeleton = skeletonize(ball);
+  unsigned long const ballPoints = countPoints(ballSkeleton);
+  ImageType::IndexType center;
+  center[0] = 20;
+  center[1] = 20;
+  center[2] = 12;
+  errors += check(ballSkeleton->GetPixel(center) == 255 &&
+                  ballPoints < countPoints(ball)/2,
+                  "wrong medial surface of the ball");
+  errors += check(isThin(ballSkeleton), "ball skeleton not thin");
+
+  // The evaluations agree on the objects, on their skeletons, and on noise
+  ImageType::Pointer noise = newImage();
+  unsigned long seed = 1;
+  for(itk::ImageRegionIterator<ImageType> it(
+        noise, noise->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+    seed = (1103515245*seed + 12345) % 2147483648UL;
+    it.Set(((seed >> 16) & 1) ? 255 : 0);
+    }
+  errors += check(sameEvaluations(plate) && sameEvaluations(plateSkeleton) &&
+                  sameEvaluations(ball) && sameEvaluations(ballSkeleton) &&
+                  sameEvaluations(noise), "different evaluations");
+
+  if(errors != 0)
+    {
+    std::cerr << errors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}